@@ -0,0 +1,544 @@
+/*
+  ==============================================================================
+
+    BiquadCascade.h
+    A fixed set of second-order section slots run in series over any number of
+    channels. The filter state of every channel lives in one contiguous array,
+    laid out [slot][lane], so the channels of a block are filtered side by side
+    in SIMD lanes. The cascade is generic over the section topology; the
+    transposed direct form II biquad is defined here and the state-variable
+    alternative in SVFCascade.h.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <complex>
+#include "KernelDispatch.h"
+
+/** Normalised second-order section, a0 == 1. */
+template<typename SampleType>
+struct BiquadCoefficients
+{
+    SampleType b0{ 1 }, b1{ 0 }, b2{ 0 }, a1{ 0 }, a2{ 0 };
+
+    double getMagnitudeForFrequency(double frequency, double sampleRate) const
+    {
+        const auto w = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+        const auto z1 = std::polar(1.0, -w);
+        const auto z2 = z1 * z1;
+
+        const auto numerator = double(b0) + double(b1) * z1 + double(b2) * z2;
+        const auto denominator = 1.0 + double(a1) * z1 + double(a2) * z2;
+
+        return std::abs(numerator / denominator);
+    }
+
+    const BiquadCoefficients& toBiquad() const { return *this; }
+};
+
+template<typename SampleType>
+BiquadCoefficients<SampleType> makeBiquadCoefficients(const std::array<SampleType, 6>& raw)
+{
+    const auto a0 = raw[3];
+
+    BiquadCoefficients<SampleType> c;
+    c.b0 = raw[0] / a0;
+    c.b1 = raw[1] / a0;
+    c.b2 = raw[2] / a0;
+    c.a1 = raw[4] / a0;
+    c.a2 = raw[5] / a0;
+    return c;
+}
+
+/** Reads a juce IIR::Coefficients object, which is already normalised. First-order sections get b2 == a2 == 0. */
+template<typename SampleType>
+BiquadCoefficients<SampleType> makeBiquadCoefficients(const juce::dsp::IIR::Coefficients<SampleType>& coefficients)
+{
+    const auto* c = coefficients.getRawCoefficients();
+
+    if (coefficients.getFilterOrder() == 1)
+        return { c[0], c[1], SampleType(0), c[2], SampleType(0) };
+
+    return { c[0], c[1], c[2], c[3], c[4] };
+}
+
+/** The designed coefficients for every slot, and which slots are in use. */
+template<typename CoefficientType, int NumSlots>
+struct SectionList
+{
+    std::array<CoefficientType, NumSlots> coefficients;
+    std::array<bool, NumSlots> active{};
+};
+
+/** The block state-space form of one TDF2 section over blocks of length samples; see TDF2Biquad. */
+template<typename SampleType>
+struct BiquadBlockKernel
+{
+    static constexpr int length = 8;
+
+    //T by input, so each input adds one contiguous column into the outputs
+    std::array<SampleType, length * length> fromInput{};
+    std::array<SampleType, length> fromState1{}, fromState2{};
+    std::array<SampleType, length> toState1{}, toState2{};
+
+    //A^L
+    SampleType s11{}, s12{}, s21{}, s22{};
+};
+
+//==============================================================================
+/** Transposed direct form II. Coefficient ramps move linearly between designs;
+    the stability region of a biquad's feedback coefficients is convex, so every
+    point on a ramp between two stable designs is stable as well.
+*/
+template<typename SampleType>
+struct TDF2Biquad
+{
+    using Coefficients = BiquadCoefficients<SampleType>;
+
+    static Coefficients makeStep(const Coefficients& from, const Coefficients& to, SampleType scale)
+    {
+        return { (to.b0 - from.b0) * scale, (to.b1 - from.b1) * scale, (to.b2 - from.b2) * scale,
+                 (to.a1 - from.a1) * scale, (to.a2 - from.a2) * scale };
+    }
+
+    static void advance(Coefficients& c, const Coefficients& step)
+    {
+        c.b0 += step.b0;
+        c.b1 += step.b1;
+        c.b2 += step.b2;
+        c.a1 += step.a1;
+        c.a2 += step.a2;
+    }
+
+    //the frames run on the dispatched kernels, in vectors of the variant the CPU runs
+    static int getVectorSize() { return KernelDispatch::getVectorSize<SampleType>(); }
+
+    //inlined into each kernel variant, so it is compiled for that variant's instruction set
+    static SIMPLEEQ_KERNEL_INLINE void processFrame(SampleType* frame, SampleType* s1, SampleType* s2, int lanes, const Coefficients& c)
+    {
+        const auto cb0 = c.b0, cb1 = c.b1, cb2 = c.b2, ca1 = c.a1, ca2 = c.a2;
+
+        //one channel per lane
+        for (int lane = 0; lane < lanes; ++lane)
+        {
+            const auto x = frame[lane];
+            const auto y = cb0 * x + s1[lane];
+            s1[lane] = cb1 * x - ca1 * y + s2[lane];
+            s2[lane] = cb2 * x - ca2 * y;
+            frame[lane] = y;
+        }
+    }
+
+    /** Runs numFrames frames through the section with fixed coefficients, on the variant of the kernel
+        picked for this CPU, or on the deterministic kernel, which is the same on every CPU.
+    */
+    static void processFrames(SampleType* frames, SampleType* s1, SampleType* s2, int lanes, int numFrames, const Coefficients& c,
+                              bool deterministic = false)
+    {
+        const auto& kernels = deterministic ? KernelDispatch::getDeterministicFilterKernels<SampleType>()
+                                            : KernelDispatch::getFilterKernels<SampleType>();
+        kernels.biquadFrames(frames, s1, s2, lanes, numFrames, c);
+    }
+
+    //==============================================================================
+    /** The section in block state-space form: blockLength outputs at once from the TDF2 state and the
+        block's inputs, through small matrix products whose lanes run across time instead of channels.
+        With s = (s1, s2), A = [-a1 1; -a2 0], B = (b1 - a1 b0, b2 - a2 b0), C = (1 0) and D = b0, a block
+        is y = O s + T u and s' = A^L s + K u, where O stacks C A^k, T holds the impulse response and K
+        the columns A^(L-1-j) B. The state is the one processFrame keeps, so the two take turns freely.
+    */
+    static constexpr bool hasBlockKernel = true;
+
+    using BlockKernel = BiquadBlockKernel<SampleType>;
+    static constexpr int blockLength = BlockKernel::length;
+
+    static void designBlockKernel(const Coefficients& c, BlockKernel& kernel)
+    {
+        const auto b0 = double(c.b0), a1 = double(c.a1), a2 = double(c.a2);
+        const auto input1 = double(c.b1) - a1 * b0, input2 = double(c.b2) - a2 * b0;
+
+        //the powers of A from A^0 to A^L, in double whatever the engine's precision
+        std::array<std::array<double, 4>, blockLength + 1> powers;
+        powers[0] = { 1.0, 0.0, 0.0, 1.0 };
+
+        for (int k = 0; k < blockLength; ++k)
+        {
+            const auto& p = powers[(size_t)k];
+            powers[(size_t)k + 1] = { -a1 * p[0] + p[2], -a1 * p[1] + p[3], -a2 * p[0], -a2 * p[1] };
+        }
+
+        std::array<double, blockLength> impulse;
+        impulse[0] = b0;
+
+        for (int k = 0; k < blockLength; ++k)
+        {
+            const auto& p = powers[(size_t)k];
+            kernel.fromState1[(size_t)k] = static_cast<SampleType>(p[0]);
+            kernel.fromState2[(size_t)k] = static_cast<SampleType>(p[1]);
+
+            if (k + 1 < blockLength)
+                impulse[(size_t)k + 1] = p[0] * input1 + p[1] * input2;
+
+            const auto& q = powers[(size_t)(blockLength - 1 - k)];
+            kernel.toState1[(size_t)k] = static_cast<SampleType>(q[0] * input1 + q[1] * input2);
+            kernel.toState2[(size_t)k] = static_cast<SampleType>(q[2] * input1 + q[3] * input2);
+        }
+
+        for (int input = 0; input < blockLength; ++input)
+        {
+            for (int output = 0; output < blockLength; ++output)
+                kernel.fromInput[(size_t)(input * blockLength + output)] = output >= input ? static_cast<SampleType>(impulse[(size_t)(output - input)])
+                                                                                           : SampleType(0);
+        }
+
+        const auto& last = powers[(size_t)blockLength];
+        kernel.s11 = static_cast<SampleType>(last[0]);
+        kernel.s12 = static_cast<SampleType>(last[1]);
+        kernel.s21 = static_cast<SampleType>(last[2]);
+        kernel.s22 = static_cast<SampleType>(last[3]);
+    }
+
+    /** Filters blockLength samples of one channel in place. */
+    static SIMPLEEQ_KERNEL_INLINE void processBlock(SampleType* samples, SampleType& s1, SampleType& s2, const BlockKernel& kernel)
+    {
+        alignas(16) std::array<SampleType, blockLength> outputs;
+
+        for (int output = 0; output < blockLength; ++output)
+            outputs[(size_t)output] = kernel.fromState1[(size_t)output] * s1 + kernel.fromState2[(size_t)output] * s2;
+
+        auto next1 = kernel.s11 * s1 + kernel.s12 * s2;
+        auto next2 = kernel.s21 * s1 + kernel.s22 * s2;
+
+        for (int input = 0; input < blockLength; ++input)
+        {
+            const auto x = samples[input];
+            const auto* column = kernel.fromInput.data() + input * blockLength;
+
+            //the outputs are independent of one another, so this is where the vectorising happens
+            for (int output = 0; output < blockLength; ++output)
+                outputs[(size_t)output] += column[output] * x;
+
+            next1 += kernel.toState1[(size_t)input] * x;
+            next2 += kernel.toState2[(size_t)input] * x;
+        }
+
+        //a loop rather than std::copy, which a kernel variant would compile for its own target
+        for (int output = 0; output < blockLength; ++output)
+            samples[output] = outputs[(size_t)output];
+
+        s1 = next1;
+        s2 = next2;
+    }
+
+    /** Runs numBlocks whole blocks of one channel through the kernel, on the variant picked for this CPU. */
+    static void processBlocks(SampleType* samples, SampleType& s1, SampleType& s2, int numBlocks, const BlockKernel& kernel)
+    {
+        KernelDispatch::getFilterKernels<SampleType>().biquadBlocks(samples, s1, s2, numBlocks, kernel);
+    }
+};
+
+//==============================================================================
+template<typename SampleType, int NumSlots, typename Topology>
+struct SectionCascade
+{
+    using Coefficients = typename Topology::Coefficients;
+    using Sections = SectionList<Coefficients, NumSlots>;
+
+    /** Sizes the state and the interleaving scratch space. The lane count is rounded up
+        to a whole number of the vectors the topology's frames run in.
+    */
+    void prepare(int maxChannels, int maxBlockSize)
+    {
+        const auto vectorSize = Topology::getVectorSize();
+
+        numLanes = juce::jmax(1, (maxChannels + vectorSize - 1) / vectorSize) * vectorSize;
+        blockSize = juce::jmax(1, maxBlockSize);
+
+        state1.assign((size_t)(NumSlots * numLanes), SampleType(0));
+        state2.assign((size_t)(NumSlots * numLanes), SampleType(0));
+        frames.assign((size_t)(blockSize * numLanes), SampleType(0));
+    }
+
+    void reset()
+    {
+        std::fill(state1.begin(), state1.end(), SampleType(0));
+        std::fill(state2.begin(), state2.end(), SampleType(0));
+    }
+
+    /** Sets the coefficients of every slot. Slots that were already running glide
+        from where they are to the new coefficients over rampLengthInSamples;
+        slots that have just switched on start on their new coefficients.
+    */
+    void setSections(const Sections& sections, int rampLengthInSamples = 0)
+    {
+        numActiveSlots = 0;
+        rampSamplesRemaining = juce::jmax(0, rampLengthInSamples);
+
+        for (int slot = 0; slot < NumSlots; ++slot)
+        {
+            if (!sections.active[slot])
+            {
+                //a slot that switches back on later should start from silence
+                clearSlotState(slot);
+                wasActive[slot] = false;
+                continue;
+            }
+
+            target[slot] = sections.coefficients[slot];
+
+            if (rampSamplesRemaining > 0 && wasActive[slot])
+            {
+                step[slot] = Topology::makeStep(current[slot], target[slot], SampleType(1) / SampleType(rampSamplesRemaining));
+            }
+            else
+            {
+                current[slot] = target[slot];
+                step[slot] = Topology::makeStep(target[slot], target[slot], SampleType(0));
+            }
+
+            wasActive[slot] = true;
+            activeSlots[numActiveSlots++] = slot;
+        }
+
+        //designed when first needed, from the coefficients any ramp lands on
+        blockKernelsDesigned = false;
+    }
+
+    int getNumActiveSlots() const { return numActiveSlots; }
+
+    /** Runs every sample through the frame kernel, in the same order whatever the block size, on
+        the deterministic kernel rather than the one picked for this CPU.
+    */
+    void setDeterministic(bool shouldBeDeterministic) { deterministic = shouldBeDeterministic; }
+
+    /** Filters a single channel in place. While no ramp is running and the topology has a block
+        kernel, the channel goes through it straight from the buffer, blockLength samples at a time,
+        so the SIMD lanes a lone channel would leave empty are filled across time instead. Otherwise,
+        or for the samples left over at the end of the block, this is the same as process(). The
+        block kernel rounds differently depending on where the blocks fall, so a deterministic
+        cascade never uses it.
+    */
+    void processSingleChannel(juce::AudioBuffer<SampleType>& buffer, int channel)
+    {
+        if constexpr (Topology::hasBlockKernel)
+        {
+            if (!deterministic && rampSamplesRemaining == 0 && numActiveSlots > 0 && numLanes > 0 && channel < buffer.getNumChannels())
+            {
+                processWithBlockKernels(buffer.getWritePointer(channel), buffer.getNumSamples());
+                return;
+            }
+        }
+
+        process(buffer, channel, 1);
+    }
+
+    /** The coefficients the slot was last set to, i.e. where any ramp is heading. */
+    const Coefficients& getActiveCoefficients(int index) const { return target[activeSlots[index]]; }
+
+    /** Filters channels [startChannel, startChannel + numChannels) in place. */
+    void process(juce::AudioBuffer<SampleType>& buffer, int startChannel, int numChannels)
+    {
+        numChannels = juce::jmin(numChannels, numLanes, buffer.getNumChannels() - startChannel);
+
+        if (numActiveSlots == 0 || numChannels <= 0)
+            return;
+
+        for (int offset = 0; offset < buffer.getNumSamples(); offset += blockSize)
+        {
+            const auto numSamples = juce::jmin(blockSize, buffer.getNumSamples() - offset);
+
+            interleave(buffer, startChannel, numChannels, offset, numSamples);
+            processFrames(numSamples);
+            deinterleave(buffer, startChannel, numChannels, offset, numSamples);
+        }
+    }
+
+    /** Filters the mid of channels 0 and 1 in place, or their side when filterSide is set, leaving the
+        other half of the pair as it was. The encode is folded into gathering the frames and the decode
+        into scattering them, so the conversion costs no passes over the block of its own. Without a
+        ramp the lone lane goes through the block kernel, as in processSingleChannel, from a contiguous
+        run of the frame buffer.
+    */
+    void processMidSide(juce::AudioBuffer<SampleType>& buffer, bool filterSide)
+    {
+        if (numActiveSlots == 0 || numLanes == 0 || buffer.getNumChannels() < 2)
+            return;
+
+        bool useBlockKernels = false;
+
+        if constexpr (Topology::hasBlockKernel)
+            useBlockKernels = !deterministic && rampSamplesRemaining == 0;
+
+        const auto stride = useBlockKernels ? 1 : numLanes;
+        const auto chunkSize = useBlockKernels ? (int)frames.size() : blockSize;
+
+        for (int offset = 0; offset < buffer.getNumSamples(); offset += chunkSize)
+        {
+            const auto numSamples = juce::jmin(chunkSize, buffer.getNumSamples() - offset);
+
+            interleaveMidSide(buffer, filterSide, offset, numSamples, stride);
+
+            if constexpr (Topology::hasBlockKernel)
+            {
+                if (useBlockKernels)
+                    processWithBlockKernels(frames.data(), numSamples);
+                else
+                    processFrames(numSamples);
+            }
+            else
+            {
+                processFrames(numSamples);
+            }
+
+            deinterleaveMidSide(buffer, filterSide, offset, numSamples, stride);
+        }
+    }
+
+private:
+    void clearSlotState(int slot)
+    {
+        std::fill(state1.begin() + slot * numLanes, state1.begin() + (slot + 1) * numLanes, SampleType(0));
+        std::fill(state2.begin() + slot * numLanes, state2.begin() + (slot + 1) * numLanes, SampleType(0));
+    }
+
+    void interleave(const juce::AudioBuffer<SampleType>& buffer, int startChannel, int numChannels, int offset, int numSamples)
+    {
+        for (int lane = 0; lane < numChannels; ++lane)
+        {
+            const auto* src = buffer.getReadPointer(startChannel + lane, offset);
+
+            for (int i = 0; i < numSamples; ++i)
+                frames[(size_t)(i * numLanes + lane)] = src[i];
+        }
+    }
+
+    void deinterleave(juce::AudioBuffer<SampleType>& buffer, int startChannel, int numChannels, int offset, int numSamples) const
+    {
+        for (int lane = 0; lane < numChannels; ++lane)
+        {
+            auto* dst = buffer.getWritePointer(startChannel + lane, offset);
+
+            for (int i = 0; i < numSamples; ++i)
+                dst[i] = frames[(size_t)(i * numLanes + lane)];
+        }
+    }
+
+    void interleaveMidSide(const juce::AudioBuffer<SampleType>& buffer, bool filterSide, int offset, int numSamples, int stride)
+    {
+        const auto* left = buffer.getReadPointer(0, offset);
+        const auto* right = buffer.getReadPointer(1, offset);
+        const auto sign = filterSide ? SampleType(-1) : SampleType(1);
+
+        for (int i = 0; i < numSamples; ++i)
+            frames[(size_t)(i * stride)] = SampleType(0.5) * (left[i] + sign * right[i]);
+    }
+
+    void deinterleaveMidSide(juce::AudioBuffer<SampleType>& buffer, bool filterSide, int offset, int numSamples, int stride) const
+    {
+        auto* left = buffer.getWritePointer(0, offset);
+        auto* right = buffer.getWritePointer(1, offset);
+        const auto sign = filterSide ? SampleType(-1) : SampleType(1);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            //the half that wasn't filtered still comes from the untouched pair
+            const auto filtered = frames[(size_t)(i * stride)];
+            const auto other = SampleType(0.5) * (left[i] - sign * right[i]);
+            const auto mid = filterSide ? other : filtered;
+            const auto side = filterSide ? filtered : other;
+
+            left[i] = mid + side;
+            right[i] = mid - side;
+        }
+    }
+
+    void processFrames(int numSamples)
+    {
+        const auto lanes = numLanes;
+        const auto rampSamples = juce::jmin(numSamples, rampSamplesRemaining);
+        const bool rampEnds = rampSamples > 0 && rampSamples == rampSamplesRemaining;
+
+        for (int index = 0; index < numActiveSlots; ++index)
+        {
+            const auto slot = activeSlots[index];
+            auto c = current[slot];
+
+            auto* s1 = state1.data() + slot * lanes;
+            auto* s2 = state2.data() + slot * lanes;
+
+            int i = 0;
+
+            for (; i < rampSamples; ++i)
+            {
+                //a deterministic render takes the ramps through the unfused kernel too, rather than the
+                //inline loop, which the compiler may fuse however the engine's build allows
+                if (deterministic)
+                    Topology::processFrames(frames.data() + i * lanes, s1, s2, lanes, 1, c, true);
+                else
+                    Topology::processFrame(frames.data() + i * lanes, s1, s2, lanes, c);
+
+                Topology::advance(c, step[slot]);
+            }
+
+            //land exactly on the design rather than on the accumulated steps
+            if (rampEnds)
+                c = target[slot];
+
+            Topology::processFrames(frames.data() + i * lanes, s1, s2, lanes, numSamples - i, c, deterministic);
+
+            current[slot] = c;
+        }
+
+        rampSamplesRemaining -= rampSamples;
+    }
+
+    void processWithBlockKernels(SampleType* samples, int numSamples)
+    {
+        constexpr auto length = Topology::blockLength;
+
+        if (!blockKernelsDesigned)
+        {
+            for (int index = 0; index < numActiveSlots; ++index)
+                Topology::designBlockKernel(current[activeSlots[index]], blockKernels[activeSlots[index]]);
+
+            blockKernelsDesigned = true;
+        }
+
+        const auto numWholeBlocks = numSamples / length;
+
+        for (int index = 0; index < numActiveSlots; ++index)
+        {
+            const auto slot = activeSlots[index];
+
+            //the channel is the first lane of the slot's state
+            auto* s1 = state1.data() + slot * numLanes;
+            auto* s2 = state2.data() + slot * numLanes;
+
+            Topology::processBlocks(samples, *s1, *s2, numWholeBlocks, blockKernels[slot]);
+
+            const auto processed = numWholeBlocks * length;
+            Topology::processFrames(samples + processed, s1, s2, 1, numSamples - processed, current[slot]);
+        }
+    }
+
+    std::array<Coefficients, NumSlots> current, target, step;
+    std::array<bool, NumSlots> wasActive{};
+    int rampSamplesRemaining = 0;
+    bool deterministic = false;
+
+    std::array<typename Topology::BlockKernel, NumSlots> blockKernels;
+    bool blockKernelsDesigned = false;
+
+    std::array<int, NumSlots> activeSlots{};
+    int numActiveSlots = 0;
+
+    std::vector<SampleType> state1, state2, frames;
+    int numLanes = 0, blockSize = 0;
+};
+
+template<typename SampleType, int NumSlots>
+using BiquadCascade = SectionCascade<SampleType, NumSlots, TDF2Biquad<SampleType>>;
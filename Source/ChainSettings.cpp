@@ -0,0 +1,43 @@
+/*
+  ==============================================================================
+
+    ChainSettings.cpp
+
+  ==============================================================================
+*/
+
+#include "ChainSettings.h"
+
+juce::StringArray getSlopeNames()
+{
+    juce::StringArray stringArray;
+    for (int i = 0; i < 4; i++)
+    {
+        juce::String str;
+        str << (12 + i * 12);
+        str << " db/Oct";
+        stringArray.add(str);
+    }
+
+    return stringArray;
+}
+
+juce::StringArray getProcessingModeNames()
+{
+    return { "Stereo", "Left", "Right", "Mid", "Side" };
+}
+
+juce::StringArray getFilterTopologyNames()
+{
+    return { "Biquad", "SVF", "Parallel" };
+}
+
+juce::StringArray getOversamplingFactorNames()
+{
+    return { "Off", "2x", "4x" };
+}
+
+juce::StringArray getOversamplingFilterNames()
+{
+    return { "IIR (Low Latency)", "FIR (Linear Phase)" };
+}
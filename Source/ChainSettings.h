@@ -0,0 +1,547 @@
+/*
+  ==============================================================================
+
+    ChainSettings.h
+    The parameter snapshot that drives the filters, plus the helpers that turn
+    it into filter coefficients. Shared by the processor, the editor and the
+    background kernel designers.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "ParametricBands.h"
+#include "PeakCoefficientTable.h"
+#include "ParallelCascade.h"
+
+enum Slope
+{
+    Slope_12,
+    Slope_24,
+    Slope_36,
+    Slope_48
+};
+
+enum ProcessingMode
+{
+    Mode_Stereo,
+    Mode_Left,
+    Mode_Right,
+    Mode_Mid,
+    Mode_Side
+};
+
+enum FilterTopology
+{
+    Topology_Biquad,
+    Topology_SVF,
+    Topology_Parallel      //the biquad sections expanded into parallel form where that holds up
+};
+
+enum OversamplingFactor
+{
+    Oversampling_Off,
+    Oversampling_2x,
+    Oversampling_4x
+};
+
+enum OversamplingFilter
+{
+    OversamplingFilter_IIR,
+    OversamplingFilter_FIR
+};
+
+struct ChainSettings
+{
+    float       peakFreq{ 0 },              peakGainInDecibels{ 0 },   peakQuality{ 1.f };
+    float       lowCutFreq{ 0 },            highCutFreq{ 0 };
+    Slope       lowCutSlope{ Slope_12 },    highCutSlope{ Slope_12 };
+    bool        lowCutBypassed{ false },    peakBypassed{ false },
+                highCutBypassed{ false }/*,   AnalyzerEnabled{ true }*/;
+    bool        globalBypassed{ false },    linearPhase{ false };
+    ProcessingMode processingMode{ Mode_Stereo };
+    FilterTopology topology{ Topology_Biquad };
+    bool        matchedResponse{ false };
+    OversamplingFactor oversamplingFactor{ Oversampling_Off };
+    OversamplingFilter oversamplingFilter{ OversamplingFilter_IIR };
+    float       oversamplingThreshold{ 0.5f };
+
+    std::array<BandSettings, MaxBands> bands;
+};
+
+inline bool operator==(const ChainSettings& a, const ChainSettings& b)
+{
+    return a.peakFreq == b.peakFreq && a.peakGainInDecibels == b.peakGainInDecibels && a.peakQuality == b.peakQuality
+        && a.lowCutFreq == b.lowCutFreq && a.highCutFreq == b.highCutFreq
+        && a.lowCutSlope == b.lowCutSlope && a.highCutSlope == b.highCutSlope
+        && a.lowCutBypassed == b.lowCutBypassed && a.peakBypassed == b.peakBypassed && a.highCutBypassed == b.highCutBypassed
+        && a.globalBypassed == b.globalBypassed && a.linearPhase == b.linearPhase
+        && a.processingMode == b.processingMode && a.topology == b.topology && a.matchedResponse == b.matchedResponse
+        && a.oversamplingFactor == b.oversamplingFactor && a.oversamplingFilter == b.oversamplingFilter
+        && a.oversamplingThreshold == b.oversamplingThreshold
+        && a.bands == b.bands;
+}
+
+inline bool operator!=(const ChainSettings& a, const ChainSettings& b) { return !(a == b); }
+
+juce::StringArray getSlopeNames();
+juce::StringArray getProcessingModeNames();
+juce::StringArray getFilterTopologyNames();
+juce::StringArray getOversamplingFactorNames();
+juce::StringArray getOversamplingFilterNames();
+
+/** True when the settings leave the signal unchanged, either because every band
+    is bypassed or because each band sits at its neutral position.
+*/
+inline bool isTransparent(const ChainSettings& chainSettings)
+{
+    const bool lowCutNeutral = chainSettings.lowCutBypassed || chainSettings.lowCutFreq <= 20.f;
+    const bool highCutNeutral = chainSettings.highCutBypassed || chainSettings.highCutFreq >= 20000.f;
+    const bool peakNeutral = chainSettings.peakBypassed || std::abs(chainSettings.peakGainInDecibels) < 0.01f;
+
+    for (const auto& band : chainSettings.bands)
+    {
+        if (isBandActive(band))
+            return false;
+    }
+
+    return lowCutNeutral && highCutNeutral && peakNeutral;
+}
+
+/** The highest centre or corner frequency among the parts of the EQ that change
+    the signal, or 0 when none do. Cut filters at the ends of the range count as off.
+*/
+inline float getHighestActiveFrequency(const ChainSettings& chainSettings)
+{
+    float highest = 0.f;
+
+    if (!chainSettings.lowCutBypassed && chainSettings.lowCutFreq > 20.f)
+        highest = juce::jmax(highest, chainSettings.lowCutFreq);
+
+    if (!chainSettings.highCutBypassed && chainSettings.highCutFreq < 20000.f)
+        highest = juce::jmax(highest, chainSettings.highCutFreq);
+
+    if (!chainSettings.peakBypassed && std::abs(chainSettings.peakGainInDecibels) >= 0.01f)
+        highest = juce::jmax(highest, chainSettings.peakFreq);
+
+    for (const auto& band : chainSettings.bands)
+    {
+        if (isBandActive(band))
+            highest = juce::jmax(highest, band.freq);
+    }
+
+    return highest;
+}
+
+template<typename SampleType>
+using FilterType = juce::dsp::IIR::Filter<SampleType>;
+
+template<typename SampleType>
+using CutFilterType = juce::dsp::ProcessorChain<FilterType<SampleType>, FilterType<SampleType>, FilterType<SampleType>, FilterType<SampleType>>;
+
+template<typename SampleType>
+using MonoChainType = juce::dsp::ProcessorChain<CutFilterType<SampleType>, FilterType<SampleType>, CutFilterType<SampleType>>;
+
+template<typename SampleType>
+using CoefficientsType = typename FilterType<SampleType>::CoefficientsPtr;
+
+using Filter = FilterType<float>;
+using CutFilter = CutFilterType<float>;
+using MonoChain = MonoChainType<float>;
+using Coefficients = CoefficientsType<float>;
+
+enum ChainPositions
+{
+    LowCut,
+    Peak,
+    HighCut
+};
+
+template<typename CoefficientsPtr>
+void updateCoefficients(CoefficientsPtr& old, const CoefficientsPtr& replacements)
+{
+    *old = *replacements;
+}
+
+template<typename SampleType = float>
+CoefficientsType<SampleType> makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    if (chainSettings.matchedResponse)
+    {
+        const auto c = MatchedDesign::toPrecision<SampleType>(MatchedDesign::makePeakFilter(sampleRate, chainSettings.peakFreq, chainSettings.peakQuality,
+                                                                                             juce::Decibels::decibelsToGain(double(chainSettings.peakGainInDecibels))));
+        return new juce::dsp::IIR::Coefficients<SampleType>(c.b0, c.b1, c.b2, SampleType(1), c.a1, c.a2);
+    }
+
+    return juce::dsp::IIR::Coefficients<SampleType>::makePeakFilter(sampleRate,
+        static_cast<SampleType>(chainSettings.peakFreq),
+        static_cast<SampleType>(chainSettings.peakQuality),
+        juce::Decibels::decibelsToGain(static_cast<SampleType>(chainSettings.peakGainInDecibels)));
+}
+
+
+template<int Index, typename ChainType, typename CoefficientType>
+void update(ChainType& chain, const CoefficientType& coefficients)
+{
+    updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]);
+    chain.template setBypassed<Index>(false);
+}
+
+template<typename ChainType, typename CoefficientType>
+void updateCutFilter(ChainType& chain, const CoefficientType& cutCoefficients, const Slope& slope)
+{
+    chain.template setBypassed<0>(true);
+    chain.template setBypassed<1>(true);
+    chain.template setBypassed<2>(true);
+    chain.template setBypassed<3>(true);
+
+    switch (slope)
+    {
+    case Slope_48:
+    {
+        update<3>(chain, cutCoefficients);
+    }
+    case Slope_36:
+    {
+        update<2>(chain, cutCoefficients);
+    }
+    case Slope_24:
+    {
+        update<1>(chain, cutCoefficients);
+    }
+    case Slope_12:
+    {
+        update<0>(chain, cutCoefficients);
+    }
+    }
+}
+
+template<typename SampleType = float>
+inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return juce::dsp::FilterDesign<SampleType>::designIIRHighpassHighOrderButterworthMethod(static_cast<SampleType>(chainSettings.lowCutFreq),
+        sampleRate,
+        2 * (chainSettings.lowCutSlope + 1));
+}
+
+template<typename SampleType = float>
+inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return juce::dsp::FilterDesign<SampleType>::designIIRLowpassHighOrderButterworthMethod(static_cast<SampleType>(chainSettings.highCutFreq),
+        sampleRate,
+        2 * (chainSettings.highCutSlope + 1));
+}
+
+/** Returns how many samples it takes for the impulse response of a second-order
+    section with the given normalised feedback coefficients to decay below the
+    given level, based on its slowest pole. First-order sections pass a2 == 0.
+*/
+inline int getDecayLengthInSamples(double a1, double a2, int order, double thresholdInDecibels)
+{
+    double poleRadius;
+    const auto discriminant = a1 * a1 - 4.0 * a2;
+
+    if (discriminant < 0.0)
+        poleRadius = std::sqrt(a2);
+    else
+        poleRadius = juce::jmax(std::abs(-a1 + std::sqrt(discriminant)), std::abs(-a1 - std::sqrt(discriminant))) * 0.5;
+
+    if (poleRadius <= 0.0)
+        return order;
+
+    //a marginally stable section never decays, so clamp it rather than report an infinite tail
+    constexpr int maxDecayLength = 1 << 22;
+    if (poleRadius >= 1.0)
+        return maxDecayLength;
+
+    const auto threshold = juce::Decibels::decibelsToGain(thresholdInDecibels, thresholdInDecibels - 1.0);
+    return juce::jmin(maxDecayLength, order + (int)std::ceil(std::log(threshold) / std::log(poleRadius)));
+}
+
+template<typename SampleType>
+int getDecayLengthInSamples(const BiquadCoefficients<SampleType>& coefficients, double thresholdInDecibels)
+{
+    const auto order = coefficients.a2 == SampleType(0) ? 1 : 2;
+    return getDecayLengthInSamples(double(coefficients.a1), double(coefficients.a2), order, thresholdInDecibels);
+}
+
+//==============================================================================
+/** Where each part of the EQ lives in the engine's BiquadCascade. A cut filter
+    takes one slot per 12dB/oct stage, the peak takes one, and the parametric
+    bands follow in band order.
+*/
+enum SectionSlots
+{
+    Section_LowCut = 0,
+    Section_Peak = Section_LowCut + 4,
+    Section_HighCut = Section_Peak + 1,
+    Section_Bands = Section_HighCut + 4,
+    MaxSections = Section_Bands + MaxBands
+};
+
+template<typename SampleType>
+using EQSectionList = SectionList<BiquadCoefficients<SampleType>, MaxSections>;
+
+template<typename SampleType>
+using EQCascade = BiquadCascade<SampleType, MaxSections>;
+
+template<typename SampleType>
+using EQSVFSectionList = SectionList<SVFCoefficients<SampleType>, MaxSections>;
+
+template<typename SampleType>
+using EQSVFCascade = SVFCascade<SampleType, MaxSections>;
+
+template<typename SampleType>
+using EQParallelCascade = ParallelCascade<SampleType, MaxSections>;
+
+/** Brings a double-precision biquad into a section of either topology at the engine's precision. */
+template<typename SampleType>
+void convertSection(const BiquadCoefficients<double>& c, BiquadCoefficients<SampleType>& section)
+{
+    section = MatchedDesign::toPrecision<SampleType>(c);
+}
+
+template<typename SampleType>
+void convertSection(const BiquadCoefficients<double>& c, SVFCoefficients<SampleType>& section)
+{
+    section = SVFDesign::fromBiquad<SampleType>(c);
+}
+
+//the section designers are overloaded on the coefficient type, so makeSectionList serves both topologies.
+//bilinear peaks come from the engine's table when it has one for the sample rate, and from the exact design otherwise
+template<typename SampleType>
+void designCutSections(EQSectionList<SampleType>& sections, int firstSlot, const ChainSettings& chainSettings, bool isLowCut, double sampleRate)
+{
+    const auto slope = isLowCut ? chainSettings.lowCutSlope : chainSettings.highCutSlope;
+    const auto freq = isLowCut ? chainSettings.lowCutFreq : chainSettings.highCutFreq;
+
+    //the same Butterworth cascade FilterDesign gives, shared between instances through the cache
+    CoefficientCache::Design design;
+    CoefficientCache::getInstance().getDesign({ isLowCut ? CoefficientCache::Design_LowCut : CoefficientCache::Design_HighCut,
+                                                2 * ((int)slope + 1), freq, 0.f, 0.f, sampleRate }, design);
+
+    for (int stage = 0; stage <= (int)slope; ++stage)
+    {
+        convertSection(design.sections[(size_t)stage], sections.coefficients[firstSlot + stage]);
+        sections.active[firstSlot + stage] = true;
+    }
+}
+
+template<typename SampleType>
+void designCutSections(EQSVFSectionList<SampleType>& sections, int firstSlot, const ChainSettings& chainSettings, bool isLowCut, double sampleRate)
+{
+    const auto slope = isLowCut ? chainSettings.lowCutSlope : chainSettings.highCutSlope;
+    const auto freq = isLowCut ? chainSettings.lowCutFreq : chainSettings.highCutFreq;
+    const auto order = 2 * ((int)slope + 1);
+
+    for (int stage = 0; stage <= (int)slope; ++stage)
+    {
+        const auto q = SVFDesign::getButterworthQ<SampleType>(stage, order);
+
+        sections.coefficients[firstSlot + stage] = isLowCut ? SVFDesign::makeHighPass<SampleType>(sampleRate, freq, q)
+                                                            : SVFDesign::makeLowPass<SampleType>(sampleRate, freq, q);
+        sections.active[firstSlot + stage] = true;
+    }
+}
+
+template<typename CoefficientType>
+bool designPeakFromTable(const PeakCoefficientTable* peakTable, double sampleRate, float freq, float quality, float gainInDecibels,
+                         CoefficientType& coefficients)
+{
+    return peakTable != nullptr && peakTable->makePeakFilter(sampleRate, freq, quality, gainInDecibels, coefficients);
+}
+
+inline BiquadCoefficients<double> getCachedPeakDesign(CoefficientCache::DesignType type, const ChainSettings& chainSettings, double sampleRate)
+{
+    CoefficientCache::Design design;
+    CoefficientCache::getInstance().getDesign({ type, 2, chainSettings.peakFreq, chainSettings.peakQuality, chainSettings.peakGainInDecibels, sampleRate }, design);
+    return design.sections[0];
+}
+
+template<typename SampleType>
+void designPeakSection(BiquadCoefficients<SampleType>& coefficients, const ChainSettings& chainSettings, double sampleRate,
+                       const PeakCoefficientTable* peakTable = nullptr)
+{
+    if (chainSettings.matchedResponse)
+        convertSection(getCachedPeakDesign(CoefficientCache::Design_MatchedPeak, chainSettings, sampleRate), coefficients);
+    else if (!designPeakFromTable(peakTable, sampleRate, chainSettings.peakFreq, chainSettings.peakQuality, chainSettings.peakGainInDecibels, coefficients))
+        convertSection(getCachedPeakDesign(CoefficientCache::Design_Peak, chainSettings, sampleRate), coefficients);
+}
+
+template<typename SampleType>
+void designPeakSection(SVFCoefficients<SampleType>& coefficients, const ChainSettings& chainSettings, double sampleRate,
+                       const PeakCoefficientTable* peakTable = nullptr)
+{
+    if (chainSettings.matchedResponse)
+        convertSection(getCachedPeakDesign(CoefficientCache::Design_MatchedPeak, chainSettings, sampleRate), coefficients);
+    else if (!designPeakFromTable(peakTable, sampleRate, chainSettings.peakFreq, chainSettings.peakQuality, chainSettings.peakGainInDecibels, coefficients))
+        coefficients = SVFDesign::makePeakFilter(sampleRate, chainSettings.peakFreq,
+                                                 static_cast<SampleType>(chainSettings.peakQuality),
+                                                 juce::Decibels::decibelsToGain(static_cast<SampleType>(chainSettings.peakGainInDecibels)));
+}
+
+template<typename SampleType>
+void designBandSection(BiquadCoefficients<SampleType>& coefficients, const BandSettings& band, double sampleRate, bool matchedResponse,
+                       const PeakCoefficientTable* peakTable = nullptr)
+{
+    if (matchedResponse || band.type != Band_Peak || !designPeakFromTable(peakTable, sampleRate, band.freq, band.quality, band.gainInDecibels, coefficients))
+        coefficients = makeBandCoefficients<SampleType>(band, sampleRate, matchedResponse);
+}
+
+template<typename SampleType>
+void designBandSection(SVFCoefficients<SampleType>& coefficients, const BandSettings& band, double sampleRate, bool matchedResponse,
+                       const PeakCoefficientTable* peakTable = nullptr)
+{
+    if (matchedResponse || band.type != Band_Peak || !designPeakFromTable(peakTable, sampleRate, band.freq, band.quality, band.gainInDecibels, coefficients))
+        coefficients = makeSVFBandCoefficients<SampleType>(band, sampleRate, matchedResponse);
+}
+
+inline bool hasSameLowCut(const ChainSettings& a, const ChainSettings& b)
+{
+    return a.lowCutFreq == b.lowCutFreq && a.lowCutSlope == b.lowCutSlope && a.lowCutBypassed == b.lowCutBypassed;
+}
+
+inline bool hasSamePeak(const ChainSettings& a, const ChainSettings& b)
+{
+    return a.peakFreq == b.peakFreq && a.peakGainInDecibels == b.peakGainInDecibels
+        && a.peakQuality == b.peakQuality && a.peakBypassed == b.peakBypassed && a.matchedResponse == b.matchedResponse;
+}
+
+inline bool hasSameHighCut(const ChainSettings& a, const ChainSettings& b)
+{
+    return a.highCutFreq == b.highCutFreq && a.highCutSlope == b.highCutSlope && a.highCutBypassed == b.highCutBypassed;
+}
+
+/** Designs every section the settings call for at the engine's precision and
+    in the topology of the list. When the settings the list was last designed
+    from are passed in, only the parts that differ from them are redesigned and
+    the rest are kept as they are. Peaks are read from peakTable when one is given.
+*/
+template<typename CoefficientType>
+void makeSectionList(SectionList<CoefficientType, MaxSections>& sections, const ChainSettings& chainSettings, double sampleRate,
+                     const ChainSettings* designedSettings = nullptr, const PeakCoefficientTable* peakTable = nullptr)
+{
+    if (designedSettings == nullptr || !hasSameLowCut(chainSettings, *designedSettings))
+    {
+        std::fill(sections.active.begin() + Section_LowCut, sections.active.begin() + Section_Peak, false);
+
+        if (!chainSettings.lowCutBypassed)
+            designCutSections(sections, Section_LowCut, chainSettings, true, sampleRate);
+    }
+
+    if (designedSettings == nullptr || !hasSamePeak(chainSettings, *designedSettings))
+    {
+        sections.active[Section_Peak] = !chainSettings.peakBypassed;
+
+        if (!chainSettings.peakBypassed)
+            designPeakSection(sections.coefficients[Section_Peak], chainSettings, sampleRate, peakTable);
+    }
+
+    if (designedSettings == nullptr || !hasSameHighCut(chainSettings, *designedSettings))
+    {
+        std::fill(sections.active.begin() + Section_HighCut, sections.active.begin() + Section_Bands, false);
+
+        if (!chainSettings.highCutBypassed)
+            designCutSections(sections, Section_HighCut, chainSettings, false, sampleRate);
+    }
+
+    for (int band = 0; band < MaxBands; ++band)
+    {
+        if (designedSettings != nullptr && chainSettings.bands[band] == designedSettings->bands[band]
+            && chainSettings.matchedResponse == designedSettings->matchedResponse)
+            continue;
+
+        sections.active[Section_Bands + band] = isBandActive(chainSettings.bands[band]);
+
+        if (sections.active[Section_Bands + band])
+            designBandSection(sections.coefficients[Section_Bands + band], chainSettings.bands[band], sampleRate, chainSettings.matchedResponse, peakTable);
+    }
+}
+
+//==============================================================================
+/** Brings a single MonoChain in line with the settings. Used wherever a chain
+    is only needed to evaluate the response rather than to process audio.
+*/
+template<typename SampleType>
+void updateMonoChain(MonoChainType<SampleType>& chain, const ChainSettings& chainSettings, double sampleRate)
+{
+    chain.template setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
+    chain.template setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
+    chain.template setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
+
+    auto peakCoefficients = makePeakFilter<SampleType>(chainSettings, sampleRate);
+    auto lowCutCoefficients = makeLowCutFilter<SampleType>(chainSettings, sampleRate);
+    auto highCutCoefficients = makeHighCutFilter<SampleType>(chainSettings, sampleRate);
+
+    updateCoefficients(chain.template get<ChainPositions::Peak>().coefficients, peakCoefficients);
+    updateCutFilter(chain.template get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
+    updateCutFilter(chain.template get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
+}
+
+template<int Index, typename CutFilterType>
+double getCutStageMagnitude(const CutFilterType& cutFilter, double freq, double sampleRate)
+{
+    if (cutFilter.template isBypassed<Index>())
+        return 1.0;
+
+    return cutFilter.template get<Index>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+}
+
+template<typename CutFilterType>
+double getCutFilterMagnitude(const CutFilterType& cutFilter, double freq, double sampleRate)
+{
+    return getCutStageMagnitude<0>(cutFilter, freq, sampleRate)
+         * getCutStageMagnitude<1>(cutFilter, freq, sampleRate)
+         * getCutStageMagnitude<2>(cutFilter, freq, sampleRate)
+         * getCutStageMagnitude<3>(cutFilter, freq, sampleRate);
+}
+
+/** The linear magnitude of the whole chain at one frequency. */
+template<typename SampleType>
+double getMagnitudeForFrequency(const MonoChainType<SampleType>& chain, double freq, double sampleRate)
+{
+    double mag = 1.0;
+
+    if (!chain.template isBypassed<ChainPositions::Peak>())
+        mag *= chain.template get<ChainPositions::Peak>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+
+    if (!chain.template isBypassed<ChainPositions::LowCut>())
+        mag *= getCutFilterMagnitude(chain.template get<ChainPositions::LowCut>(), freq, sampleRate);
+
+    if (!chain.template isBypassed<ChainPositions::HighCut>())
+        mag *= getCutFilterMagnitude(chain.template get<ChainPositions::HighCut>(), freq, sampleRate);
+
+    return mag;
+}
+
+//==============================================================================
+/** In-place mid/side conversion. Each is a single pass over the two channels
+    with no aliasing between the outputs of one iteration and the inputs of the
+    next, so the compiler vectorises the loop.
+*/
+template<typename SampleType>
+void encodeMidSide(SampleType* left, SampleType* right, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto l = left[i];
+        const auto r = right[i];
+        left[i] = SampleType(0.5) * (l + r);
+        right[i] = SampleType(0.5) * (l - r);
+    }
+}
+
+template<typename SampleType>
+void decodeMidSide(SampleType* mid, SampleType* side, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto m = mid[i];
+        const auto s = side[i];
+        mid[i] = m + s;
+        side[i] = m - s;
+    }
+}
@@ -0,0 +1,208 @@
+/*
+  ==============================================================================
+
+    ChannelWorkerPool.cpp
+
+  ==============================================================================
+*/
+
+#include "ChannelWorkerPool.h"
+#include <thread>
+
+juce::StringArray getThreadingModeNames()
+{
+    return { "Off", "Offline Only", "Always" };
+}
+
+//==============================================================================
+ChannelWorkerPool::Worker::Worker(ChannelWorkerPool& p, int index)
+    : juce::Thread("SimpleEQ Channel Worker " + juce::String(index)), pool(p), participant(index)
+{
+}
+
+void ChannelWorkerPool::Worker::run()
+{
+    while (!threadShouldExit())
+    {
+        wait(-1);
+
+        if (threadShouldExit())
+            break;
+
+        pool.activeWorkers.fetch_add(1);
+
+        if (auto* job = pool.currentJob.load())
+            pool.runTasks(*job, participant);
+
+        pool.activeWorkers.fetch_sub(1);
+    }
+}
+
+//==============================================================================
+ChannelWorkerPool::~ChannelWorkerPool()
+{
+    stop();
+}
+
+void ChannelWorkerPool::start(int numWorkersToUse)
+{
+    stop();
+
+    if (numWorkersToUse <= 0)
+        return;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(runLock);
+
+        //participant 0 is the thread calling run(), the workers are 1..numWorkersToUse
+        queues.reset(new TaskQueue[(size_t)numWorkersToUse + 1]);
+
+        for (int index = 1; index <= numWorkersToUse; ++index)
+        {
+            workers.push_back(std::make_unique<Worker>(*this, index));
+            workers.back()->startRealtimeThread(juce::Thread::RealtimeOptions{});
+        }
+
+        numWorkers.store(numWorkersToUse);
+    }
+
+    struct EmptyJob : Job
+    {
+        void runTask(int) override {}
+    } emptyJob;
+
+    //the best of a few round trips, so a cold start or a preempted worker doesn't skew it
+    auto best = std::numeric_limits<juce::int64>::max();
+
+    for (int attempt = 0; attempt < 8; ++attempt)
+    {
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+
+        if (run(emptyJob, numWorkersToUse + 1))
+            best = juce::jmin(best, juce::Time::getHighResolutionTicks() - startTicks);
+    }
+
+    if (best != std::numeric_limits<juce::int64>::max())
+        dispatchOverheadSeconds.store(juce::Time::highResolutionTicksToSeconds(best));
+}
+
+void ChannelWorkerPool::stop()
+{
+    //waits for a run() in progress on the audio thread to finish
+    const juce::SpinLock::ScopedLockType lock(runLock);
+
+    numWorkers.store(0);
+
+    for (auto& worker : workers)
+        worker->signalThreadShouldExit();
+
+    for (auto& worker : workers)
+    {
+        worker->notify();
+        worker->stopThread(1000);
+    }
+
+    workers.clear();
+    queues.reset();
+}
+
+bool ChannelWorkerPool::run(Job& job, int numTasks)
+{
+    const juce::SpinLock::ScopedTryLockType lock(runLock);
+
+    const auto workerCount = numWorkers.load();
+
+    if (!lock.isLocked() || workerCount == 0 || numTasks <= 0)
+        return false;
+
+    //deal the tasks out in contiguous runs; the stealing evens out whatever the split gets wrong
+    const auto participants = workerCount + 1;
+
+    for (int participant = 0; participant < participants; ++participant)
+    {
+        const auto begin = (juce::uint32)(numTasks * participant / participants);
+        const auto end = (juce::uint32)(numTasks * (participant + 1) / participants);
+        queues[(size_t)participant].range.store(packRange(begin, end), std::memory_order_relaxed);
+    }
+
+    remainingTasks.store(numTasks);
+    currentJob.store(&job);
+
+    for (auto& worker : workers)
+        worker->notify();
+
+    runTasks(job, 0);
+
+    //every task has been taken by now, so this only waits on the ones still running elsewhere
+    while (remainingTasks.load(std::memory_order_acquire) > 0)
+        std::this_thread::yield();
+
+    //a worker that hasn't started by now has nothing left to do; the ones that have are leaving the
+    //empty queues, and have to be out before the next run() deals new ones
+    currentJob.store(nullptr);
+
+    while (activeWorkers.load() > 0)
+        std::this_thread::yield();
+
+    return true;
+}
+
+void ChannelWorkerPool::runTasks(Job& job, int participant)
+{
+    int task;
+
+    while (popFront(participant, task) || stealBack(participant, task))
+    {
+        job.runTask(task);
+        remainingTasks.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+bool ChannelWorkerPool::popFront(int participant, int& task)
+{
+    auto& range = queues[(size_t)participant].range;
+    auto current = range.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        const auto begin = (juce::uint32)(current & 0xffffffffu);
+        const auto end = (juce::uint32)(current >> 32);
+
+        if (begin >= end)
+            return false;
+
+        if (range.compare_exchange_weak(current, packRange(begin + 1, end), std::memory_order_acq_rel))
+        {
+            task = (int)begin;
+            return true;
+        }
+    }
+}
+
+bool ChannelWorkerPool::stealBack(int participant, int& task)
+{
+    const auto participants = numWorkers.load() + 1;
+
+    for (int offset = 1; offset < participants; ++offset)
+    {
+        auto& range = queues[(size_t)((participant + offset) % participants)].range;
+        auto current = range.load(std::memory_order_acquire);
+
+        for (;;)
+        {
+            const auto begin = (juce::uint32)(current & 0xffffffffu);
+            const auto end = (juce::uint32)(current >> 32);
+
+            if (begin >= end)
+                break;
+
+            if (range.compare_exchange_weak(current, packRange(begin, end - 1), std::memory_order_acq_rel))
+            {
+                task = (int)(end - 1);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    ChannelWorkerPool.h
+    A small persistent pool that spreads the channel groups of one block over
+    several cores. Tasks are dealt out to per-participant queues up front, and
+    a participant that runs out of its own work steals from the back of the
+    others, so uneven groups still finish together. The calling thread takes
+    part as well, and run() only returns once every task has finished. The
+    workers run at realtime priority, since the audio thread waits on them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/** How the Threading parameter spreads a block over the pool. With the pool off, the channels
+    run in groups of eight, one SIMD cascade each; with it on, they are regrouped as narrow as
+    a channel each, so a bus splits over up to one task per core. Mono never threads. Stereo
+    can split into two single-channel tasks, but only once a block costs enough to outweigh
+    the hand-off, which at typical block sizes it rarely does, so in practice stereo stays on
+    the audio thread. Switching between Off and the other modes regroups the channels and
+    resets the filters.
+*/
+enum ThreadingMode
+{
+    Threading_Off,
+    Threading_Offline,
+    Threading_Always
+};
+
+juce::StringArray getThreadingModeNames();
+
+//==============================================================================
+class ChannelWorkerPool
+{
+public:
+    struct Job
+    {
+        virtual ~Job() = default;
+        virtual void runTask(int taskIndex) = 0;
+    };
+
+    ChannelWorkerPool() = default;
+    ~ChannelWorkerPool();
+
+    /** Starts the worker threads and measures the cost of a dispatch. Call from the message thread. */
+    void start(int numWorkersToUse);
+    void stop();
+
+    bool isRunning() const { return numWorkers.load() > 0; }
+    int getNumWorkers() const { return numWorkers.load(); }
+
+    /** The measured round trip of handing out an empty job and waiting for it, in seconds. */
+    double getDispatchOverheadSeconds() const { return dispatchOverheadSeconds.load(); }
+
+    /** Runs job.runTask(0 .. numTasks - 1) across the workers and the calling thread.
+        Returns false without running anything if the pool is stopped or being
+        restarted, in which case the caller should do the work itself.
+    */
+    bool run(Job& job, int numTasks);
+
+private:
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker(ChannelWorkerPool& p, int index);
+        void run() override;
+
+    private:
+        ChannelWorkerPool& pool;
+        const int participant;
+    };
+
+    //each queue is a [begin, end) range of task indices packed into one word, so the
+    //owner can take from the front and thieves from the back with a single compare-exchange
+    struct alignas(64) TaskQueue
+    {
+        std::atomic<juce::uint64> range{ 0 };
+    };
+
+    static juce::uint64 packRange(juce::uint32 begin, juce::uint32 end) { return (juce::uint64(end) << 32) | begin; }
+
+    bool popFront(int participant, int& task);
+    bool stealBack(int participant, int& task);
+    void runTasks(Job& job, int participant);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::unique_ptr<TaskQueue[]> queues;
+
+    std::atomic<Job*> currentJob{ nullptr };
+    std::atomic<int> numWorkers{ 0 };
+
+    //run() waits for the tasks, and then only for the workers that are inside the job; one that
+    //wakes after the job has gone finds currentJob cleared and goes back to sleep
+    std::atomic<int> remainingTasks{ 0 };
+    std::atomic<int> activeWorkers{ 0 };
+    std::atomic<double> dispatchOverheadSeconds{ 0.0 };
+
+    juce::SpinLock runLock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChannelWorkerPool)
+};
@@ -0,0 +1,183 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.cpp
+
+  ==============================================================================
+*/
+
+#include "CoefficientCache.h"
+#include "MatchedDesign.h"
+#include "SVFCascade.h"
+#include <cstring>
+
+namespace
+{
+    //JUCE's bilinear second-order low and high-pass, as FilterDesign cascades them, without the allocation
+    BiquadCoefficients<double> makeButterworthStage(double sampleRate, double frequency, double quality, bool isHighPass)
+    {
+        const auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+        const auto nSquared = n * n;
+        const auto invQ = 1.0 / quality;
+        const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+        const auto a1 = c1 * 2.0 * (1.0 - nSquared);
+        const auto a2 = c1 * (1.0 - invQ * n + nSquared);
+
+        if (isHighPass)
+            return { c1 * nSquared, -2.0 * c1 * nSquared, c1 * nSquared, a1, a2 };
+
+        return { c1, 2.0 * c1, c1, a1, a2 };
+    }
+
+    juce::uint32 getBits(float value)
+    {
+        juce::uint32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+}
+
+CoefficientCache& CoefficientCache::getInstance()
+{
+    static CoefficientCache instance;
+    return instance;
+}
+
+void CoefficientCache::getDesign(const Key& key, Design& design)
+{
+    const auto set = (int)(hashKey(key) & (numSets - 1));
+    auto& ways = sets[(size_t)set];
+
+    for (const auto& entry : ways)
+    {
+        if (tryRead(entry, key, design))
+        {
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    misses.fetch_add(1, std::memory_order_relaxed);
+    makeDesign(key, design);
+    store(ways, set, key, design);
+}
+
+CoefficientCache::Stats CoefficientCache::getStats() const
+{
+    return { hits.load(std::memory_order_relaxed), misses.load(std::memory_order_relaxed), evictions.load(std::memory_order_relaxed) };
+}
+
+void CoefficientCache::resetStats()
+{
+    hits.store(0);
+    misses.store(0);
+    evictions.store(0);
+}
+
+void CoefficientCache::makeDesign(const Key& key, Design& design)
+{
+    const auto gainFactor = juce::Decibels::decibelsToGain(double(key.gainInDecibels));
+
+    switch (key.type)
+    {
+    case Design_LowCut:
+    case Design_HighCut:
+        //even orders only, which is all the cut slopes produce
+        jassert(key.order % 2 == 0 && key.order / 2 <= maxSections);
+        design.numSections = juce::jlimit(1, maxSections, key.order / 2);
+
+        for (int stage = 0; stage < design.numSections; ++stage)
+            design.sections[(size_t)stage] = makeButterworthStage(key.sampleRate, key.frequency, SVFDesign::getButterworthQ<double>(stage, key.order),
+                                                                  key.type == Design_LowCut);
+        break;
+
+    case Design_Peak:
+        design.numSections = 1;
+        design.sections[0] = makeBiquadCoefficients(juce::dsp::IIR::ArrayCoefficients<double>::makePeakFilter(key.sampleRate, key.frequency,
+                                                                                                              key.quality, gainFactor));
+        break;
+
+    case Design_MatchedPeak:
+        design.numSections = 1;
+        design.sections[0] = MatchedDesign::makePeakFilter(key.sampleRate, key.frequency, key.quality, gainFactor);
+        break;
+
+    case Design_MatchedLowShelf:
+        design.numSections = 1;
+        design.sections[0] = MatchedDesign::makeLowShelf(key.sampleRate, key.frequency, key.quality, gainFactor);
+        break;
+
+    case Design_MatchedHighShelf:
+        design.numSections = 1;
+        design.sections[0] = MatchedDesign::makeHighShelf(key.sampleRate, key.frequency, key.quality, gainFactor);
+        break;
+    }
+}
+
+juce::uint32 CoefficientCache::hashKey(const Key& key)
+{
+    juce::uint64 rateBits;
+    std::memcpy(&rateBits, &key.sampleRate, sizeof(rateBits));
+
+    const juce::uint32 words[] = { (juce::uint32)key.type, (juce::uint32)key.order, getBits(key.frequency), getBits(key.quality),
+                                   getBits(key.gainInDecibels), (juce::uint32)rateBits, (juce::uint32)(rateBits >> 32) };
+
+    //FNV-1a over the words
+    juce::uint32 hash = 2166136261u;
+
+    for (auto word : words)
+    {
+        hash ^= word;
+        hash *= 16777619u;
+    }
+
+    return hash ^ (hash >> 16);
+}
+
+bool CoefficientCache::tryRead(const Entry& entry, const Key& key, Design& design)
+{
+    const auto before = entry.version.load(std::memory_order_acquire);
+
+    if (before == 0 || (before & 1) != 0 || !(entry.key == key))
+        return false;
+
+    design = entry.design;
+
+    //the copy only counts if nothing was written over the entry while it was being made
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return entry.version.load(std::memory_order_relaxed) == before;
+}
+
+void CoefficientCache::store(std::array<Entry, numWays>& ways, int set, const Key& key, const Design& design)
+{
+    //an empty way if there is one, otherwise the set's next way in round-robin order
+    auto way = -1;
+
+    for (int index = 0; index < numWays && way < 0; ++index)
+    {
+        if (ways[(size_t)index].version.load(std::memory_order_relaxed) == 0)
+            way = index;
+    }
+
+    if (way < 0)
+        way = (int)(nextVictims[(size_t)set].fetch_add(1, std::memory_order_relaxed) % numWays);
+
+    auto& entry = ways[(size_t)way];
+    auto version = entry.version.load(std::memory_order_relaxed);
+
+    //another thread is writing this way; the design just isn't cached this time
+    if ((version & 1) != 0 || !entry.version.compare_exchange_strong(version, version + 1, std::memory_order_acquire))
+        return;
+
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (version != 0)
+        evictions.fetch_add(1, std::memory_order_relaxed);
+
+    entry.key = key;
+    entry.design = design;
+
+    //skip 0 when the counter wraps, so a filled entry never reads as empty
+    entry.version.store(version + 2 == 0 ? 2 : version + 2, std::memory_order_release);
+}
@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.h
+    A process-wide cache of designed sections, shared by every instance of the
+    plugin, so a session full of identical cuts and matched shelves designs
+    each one once. Designs are keyed on their type, order, frequency, Q, gain
+    and sample rate, and handed out as copies.
+
+    The cache is a fixed set-associative table in static storage: it never
+    allocates, and when a set is full its ways are overwritten round-robin,
+    which needs no bookkeeping on a hit and no notion of age. Each entry is
+    guarded by a version counter that is odd while it is being written, so
+    lookups never block or wait. A lookup that races with a write counts as
+    a miss, and so does a store that finds its way busy.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "BiquadCascade.h"
+
+class CoefficientCache
+{
+public:
+    enum DesignType
+    {
+        Design_LowCut,              //Butterworth high-pass of the given order
+        Design_HighCut,             //Butterworth low-pass of the given order
+        Design_Peak,                //RBJ peak
+        Design_MatchedPeak,
+        Design_MatchedLowShelf,
+        Design_MatchedHighShelf
+    };
+
+    //a 48dB/oct cut
+    static constexpr int maxSections = 4;
+
+    struct Key
+    {
+        DesignType type;
+        int order;
+        float frequency, quality, gainInDecibels;
+        double sampleRate;
+
+        bool operator==(const Key& other) const
+        {
+            return type == other.type && order == other.order && frequency == other.frequency && quality == other.quality
+                && gainInDecibels == other.gainInDecibels && sampleRate == other.sampleRate;
+        }
+    };
+
+    struct Design
+    {
+        std::array<BiquadCoefficients<double>, maxSections> sections;
+        int numSections = 0;
+    };
+
+    struct Stats
+    {
+        juce::uint64 hits = 0, misses = 0, evictions = 0;
+    };
+
+    static CoefficientCache& getInstance();
+
+    /** Copies the design for the key into design, designing and storing it first on a miss.
+        Safe on any thread, including the audio thread.
+    */
+    void getDesign(const Key& key, Design& design);
+
+    Stats getStats() const;
+    void resetStats();
+
+    /** The design itself, without the cache. Doesn't allocate. */
+    static void makeDesign(const Key& key, Design& design);
+
+    static constexpr int numSets = 512;
+    static constexpr int numWays = 4;
+
+private:
+    struct Entry
+    {
+        //0 while empty, odd while being written
+        std::atomic<juce::uint32> version{ 0 };
+        Key key{};
+        Design design;
+    };
+
+    std::array<std::array<Entry, numWays>, numSets> sets;
+    //the way each full set overwrites next, advanced on every eviction regardless of use
+    std::array<std::atomic<juce::uint32>, numSets> nextVictims{};
+
+    std::atomic<juce::uint64> hits{ 0 }, misses{ 0 }, evictions{ 0 };
+
+    static juce::uint32 hashKey(const Key& key);
+    static bool tryRead(const Entry& entry, const Key& key, Design& design);
+    void store(std::array<Entry, numWays>& ways, int set, const Key& key, const Design& design);
+};
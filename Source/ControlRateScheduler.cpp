@@ -0,0 +1,53 @@
+/*
+  ==============================================================================
+
+    ControlRateScheduler.cpp
+
+  ==============================================================================
+*/
+
+#include "ControlRateScheduler.h"
+
+juce::StringArray getControlRateNames()
+{
+    juce::StringArray names;
+
+    for (auto length : controlRateTickLengths)
+    {
+        juce::String str;
+        str << length << " Samples";
+        names.add(str);
+    }
+
+    return names;
+}
+
+void ControlRateScheduler::reset()
+{
+    position = 0;
+
+    numTicks.store(0);
+    totalSeconds.store(0.0);
+    maxSeconds.store(0.0);
+}
+
+ControlRateScheduler::TickStats ControlRateScheduler::getTickStats() const
+{
+    TickStats stats;
+    stats.numTicks = numTicks.load();
+    stats.totalSeconds = totalSeconds.load();
+    stats.maxSeconds = maxSeconds.load();
+    return stats;
+}
+
+void ControlRateScheduler::recordTick(juce::int64 elapsedTicks)
+{
+    //only the audio thread writes these, so plain load/store pairs are enough
+    const auto seconds = juce::Time::highResolutionTicksToSeconds(elapsedTicks);
+
+    numTicks.store(numTicks.load() + 1);
+    totalSeconds.store(totalSeconds.load() + seconds);
+
+    if (seconds > maxSeconds.load())
+        maxSeconds.store(seconds);
+}
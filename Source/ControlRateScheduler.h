@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    ControlRateScheduler.h
+    A fixed control-rate clock running on the sample timeline. Parameter reads
+    and coefficient updates happen on its ticks rather than once per host
+    callback, so the control cost depends on the tick length instead of on the
+    host's buffer size, and the points where new coefficients take effect are
+    the same however the host splits its blocks.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+//tick lengths offered by the "Control Rate" parameter, indexed by its choice
+static constexpr int controlRateTickLengths[] = { 64, 128 };
+
+juce::StringArray getControlRateNames();
+
+class ControlRateScheduler
+{
+public:
+    /** Restarts the clock at sample 0 and clears the tick statistics. */
+    void reset();
+
+    void setTickLength(int newTickLength) { tickLength = juce::jmax(1, newTickLength); }
+    int getTickLength() const { return tickLength; }
+
+    /** Walks one block of numSamples. At every tick that falls inside it, isDue()
+        is asked whether there is control work; if so, the audio up to the tick
+        is rendered with render(start, length) and then tick() runs. Whatever is
+        left after the last tick is rendered in one piece, so a block with
+        nothing to update reaches render() exactly once.
+    */
+    template<typename IsDueFunction, typename TickFunction, typename RenderFunction>
+    void processBlock(int numSamples, IsDueFunction&& isDue, TickFunction&& tick, RenderFunction&& render)
+    {
+        const auto offset = (int)(position % tickLength);
+        int rangeStart = 0;
+
+        for (int boundary = offset == 0 ? 0 : tickLength - offset; boundary < numSamples; boundary += tickLength)
+        {
+            if (!isDue())
+                continue;
+
+            if (boundary > rangeStart)
+            {
+                render(rangeStart, boundary - rangeStart);
+                rangeStart = boundary;
+            }
+
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            tick();
+            recordTick(juce::Time::getHighResolutionTicks() - startTicks);
+        }
+
+        if (rangeStart < numSamples)
+            render(rangeStart, numSamples - rangeStart);
+
+        position += numSamples;
+    }
+
+    /** Cost of the ticks that did work since the last reset. Safe to read from any thread. */
+    struct TickStats
+    {
+        juce::int64 numTicks = 0;
+        double totalSeconds = 0.0, maxSeconds = 0.0;
+
+        double getAverageSeconds() const { return numTicks > 0 ? totalSeconds / (double)numTicks : 0.0; }
+    };
+
+    TickStats getTickStats() const;
+
+private:
+    void recordTick(juce::int64 elapsedTicks);
+
+    int tickLength = controlRateTickLengths[0];
+    juce::int64 position = 0;
+
+    std::atomic<juce::int64> numTicks{ 0 };
+    std::atomic<double> totalSeconds{ 0.0 }, maxSeconds{ 0.0 };
+};
@@ -0,0 +1,847 @@
+/*
+  ==============================================================================
+
+    EQEngine.h
+    The filter engine behind processBlock. The channels of the bus are split
+    into groups of up to eight, narrower when the worker pool is in use, each with its own cascade of biquad or state-variable
+    sections, or of the biquads expanded into parallel branches, depending on
+    the chosen topology, so any layout from mono
+    up to wide immersive and ambisonic formats is filtered in SIMD lanes and
+    the groups can be handed to a ChannelWorkerPool when a block is big enough
+    to be worth spreading over several cores.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+#include "LinearPhaseEQ.h"
+#include "ChannelWorkerPool.h"
+#include "OversamplingStage.h"
+#include "PresetBank.h"
+#include "SnapshotMorph.h"
+
+/** Templated on sample type so that the float and double processBlock overloads
+    each run filters designed and processed at their own precision.
+*/
+template<typename SampleType>
+struct EQEngine
+{
+    //input below this level counts as silence, and the tail ends once the filters have decayed below it
+    static constexpr double silenceThresholdInDecibels = -120.0;
+
+    //length of the fade used when the engine engages or disengages, and when the oversampler does
+    static constexpr double crossfadeLengthInSeconds = 0.01;
+
+    //channels per cascade, and so per task handed to the worker pool, when the pool isn't narrowing them
+    static constexpr int maxChannelsPerGroup = 8;
+
+    /** The group width for a bus: whole SIMD-friendly groups when one thread runs them all, or narrower
+        ones, down to a channel each, so the bus splits into as many tasks as there are threads to take them.
+    */
+    static int getChannelsPerGroup(int numChannels, int maxTasks)
+    {
+        if (maxTasks <= 1)
+            return maxChannelsPerGroup;
+
+        return juce::jlimit(1, maxChannelsPerGroup, (numChannels + maxTasks - 1) / maxTasks);
+    }
+
+    //a block goes to the pool once its estimated serial cost is this many times the pool's dispatch overhead
+    static constexpr double parallelCostRatio = 4.0;
+
+    //once engaged, the oversampler stays on until the highest band drops this far below the threshold
+    static constexpr double oversamplingHysteresis = 0.9;
+
+    /** maxTasks is how many threads may share a block, 1 unless the worker pool is in use. */
+    void prepare(const juce::dsp::ProcessSpec& spec, int maxTasks = 1)
+    {
+        channelsPerGroup = getChannelsPerGroup((int)spec.numChannels, maxTasks);
+        const auto numGroups = juce::jmax(1, ((int)spec.numChannels + channelsPerGroup - 1) / channelsPerGroup);
+
+        //the spare set takes over the outgoing rate's filters while the oversampler engages or disengages
+        for (int set = 0; set < 2; ++set)
+        {
+            cascades.resize((size_t)numGroups);
+            svfCascades.resize((size_t)numGroups);
+            parallelCascades.resize((size_t)numGroups);
+
+            for (int group = 0; group < numGroups; ++group)
+            {
+                const auto groupChannels = juce::jmin(channelsPerGroup, (int)spec.numChannels - group * channelsPerGroup);
+                cascades[(size_t)group].prepare(groupChannels, (int)spec.maximumBlockSize);
+                svfCascades[(size_t)group].prepare(groupChannels, (int)spec.maximumBlockSize);
+                parallelCascades[(size_t)group].prepare(groupChannels, (int)spec.maximumBlockSize);
+            }
+
+            swapWithOutgoingCascades();
+        }
+
+        dryBuffer.setSize((int)spec.numChannels, (int)spec.maximumBlockSize, false, true, false);
+        rateFadeBuffer.setSize((int)spec.numChannels, (int)spec.maximumBlockSize, false, true, false);
+        rateFadeLength = juce::jmax(1, juce::roundToInt(crossfadeLengthInSeconds * spec.sampleRate));
+        rateFadeSamplesRemaining = 0;
+
+        //juce::dsp::Convolution only runs in single precision, so the double engine converts through this
+        if constexpr (!std::is_same_v<SampleType, float>)
+            linearPhaseBuffer.setSize((int)spec.numChannels, (int)spec.maximumBlockSize, false, true, false);
+
+        //channels left out of the linear-phase path still need to line up with the ones going through it
+        linearPhaseDelay.setMaximumDelayInSamples(LinearPhaseEQ::getKernelSizeForSampleRate(spec.sampleRate) + 4 * LinearPhaseEQ::partitionSize);
+        linearPhaseDelay.prepare(spec);
+
+        //peaks are designed by table lookup at this rate, so automating them costs next to nothing
+        peakTable.prepare(spec.sampleRate);
+
+        oversampling.prepare(spec);
+
+        wetGain.reset(spec.sampleRate, crossfadeLengthInSeconds);
+        wetGain.setCurrentAndTargetValue(isEngaged ? SampleType(1) : SampleType(0));
+
+        silentSamples = 0;
+        isIdle = false;
+
+        //the cascades have just been rebuilt
+        setDeterministic(deterministic);
+
+        //forces a full redesign on the next update
+        designedSampleRate = 0.0;
+    }
+
+    int getNumGroups() const { return (int)cascades.size(); }
+
+    /** The linear-phase convolver is owned by the processor and shared by both precisions. */
+    void setLinearPhaseEQ(LinearPhaseEQ* eq) { linearPhaseEQ = eq; }
+
+    /** The worker pool is owned by the processor too; nullptr keeps every block on the calling thread. */
+    void setWorkerPool(ChannelWorkerPool* pool) { workerPool = pool; }
+
+    /** Allows blocks that are large enough to be split over the worker pool. */
+    void setUseWorkerPool(bool shouldUse) { useWorkerPool = shouldUse; }
+
+    /** Makes the output bit-for-bit the same however the host splits the blocks and on whichever CPU
+        the build runs: the cascades run every sample through the same unfused kernel in the same order,
+        blocks larger than the prepared size are rendered in pieces so the crossfades always run, and
+        neither silence nor a full disengage stops the filters. Parameters already take effect on the
+        control clock rather than per block. The linear-phase path rebuilds its kernels on a background
+        thread, so it isn't covered.
+    */
+    void setDeterministic(bool shouldBeDeterministic)
+    {
+        deterministic = shouldBeDeterministic;
+
+        for (int set = 0; set < 2; ++set)
+        {
+            for (auto& cascade : cascades)
+                cascade.setDeterministic(deterministic);
+
+            for (auto& cascade : svfCascades)
+                cascade.setDeterministic(deterministic);
+
+            for (auto& cascade : parallelCascades)
+                cascade.setDeterministic(deterministic);
+
+            swapWithOutgoingCascades();
+        }
+    }
+
+    /** Redesigns the filters for the settings. With a ramp length, sections that
+        stay active glide to their new coefficients over that many samples.
+        When the settings are those of a preset with sections stored for the
+        design rate, the sections are taken from it rather than designed, and
+        the cascades crossfade to them.
+    */
+    void updateFilters(const ChainSettings& chainSettings, double sampleRate, int rampLengthInSamples = 0,
+                       const PresetBank::Preset* preset = nullptr)
+    {
+        const auto designRate = beginUpdate(chainSettings, sampleRate, rampLengthInSamples);
+
+        //only the parts of the EQ whose settings moved since the last update are redesigned
+        const auto* previousSettings = designRate == designedSampleRate ? &designedSettings : nullptr;
+        const auto* presetSections = preset != nullptr ? preset->findSections(designRate) : nullptr;
+
+        //a program change swaps every section at once, so it always gets at least the crossfade's length
+        if (presetSections != nullptr)
+            rampLengthInSamples = juce::jmax(rampLengthInSamples, juce::roundToInt(crossfadeLengthInSeconds * designRate));
+
+        if (topology == Topology_SVF)
+        {
+            if (presetSections != nullptr)
+                presetSections->loadInto(svfSections);
+            else
+                makeSectionList(svfSections, chainSettings, designRate, previousSettings, &peakTable);
+
+            for (auto& cascade : svfCascades)
+                cascade.setSections(svfSections, rampLengthInSamples);
+        }
+        else
+        {
+            if (presetSections != nullptr)
+                presetSections->loadInto(sections);
+            else
+                makeSectionList(sections, chainSettings, designRate, previousSettings, &peakTable);
+
+            setBiquadSections(designRate, rampLengthInSamples);
+        }
+
+        designedSettings = chainSettings;
+        designedSampleRate = designRate;
+
+        tailLengthInSamples = computeTailLengthInSamples();
+    }
+
+    /** Sets the filters part way between two snapshots, given the morphed settings for everything
+        other than the sections. Each snapshot is designed once for the rate; after that, moving the
+        morph only blends their coefficients.
+    */
+    void updateFiltersMorphed(const ChainSettings& morphedSettings, const SnapshotMorph::Snapshots& snapshots,
+                              const SnapshotMorph::Segment& segment, double sampleRate, int rampLengthInSamples = 0)
+    {
+        const auto designRate = beginUpdate(morphedSettings, sampleRate, rampLengthInSamples, &snapshots, &segment);
+
+        if (snapshots.generation != designedSnapshotGeneration || designRate != designedSnapshotRate)
+        {
+            for (int index = 0; index < SnapshotMorph::maxSnapshots; ++index)
+            {
+                if (snapshots.stored[(size_t)index])
+                    makeSectionList(snapshotSections[(size_t)index], snapshots.settings[(size_t)index], designRate);
+            }
+
+            designedSnapshotGeneration = snapshots.generation;
+            designedSnapshotRate = designRate;
+        }
+
+        const auto& from = snapshotSections[(size_t)segment.from];
+        const auto& to = snapshotSections[(size_t)segment.to];
+
+        if (topology == Topology_SVF)
+        {
+            SnapshotMorph::blendSections(svfSections, from, to, segment.amount);
+
+            for (auto& cascade : svfCascades)
+                cascade.setSections(svfSections, rampLengthInSamples);
+        }
+        else
+        {
+            SnapshotMorph::blendSections(sections, from, to, segment.amount);
+            setBiquadSections(designRate, rampLengthInSamples);
+        }
+
+        //the blended sections aren't the design of any settings, so the next plain update starts over
+        designedSampleRate = 0.0;
+
+        tailLengthInSamples = computeTailLengthInSamples();
+    }
+
+    int getTailLengthInSamples() const { return tailLengthInSamples; }
+
+    /** The latency the oversampling mode adds, constant for as long as the mode is selected. */
+    int getLatencyInSamples() const { return oversampling.getLatencyInSamples(); }
+
+    void process(juce::AudioBuffer<SampleType>& buffer)
+    {
+        const auto numSamples = buffer.getNumSamples();
+
+        //the oversampling buffers only hold a prepared block, and a deterministic render can't let the block
+        //size decide whether a crossfade runs, so in either case anything larger is rendered in pieces
+        const auto maxPieceSize = oversampling.isSelected() ? oversampling.getMaximumBlockSize()
+                                : deterministic             ? juce::jmax(1, dryBuffer.getNumSamples())
+                                                            : numSamples;
+
+        if (numSamples > maxPieceSize)
+        {
+            for (int offset = 0; offset < numSamples; offset += maxPieceSize)
+            {
+                juce::AudioBuffer<SampleType> subBlock(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), offset,
+                                                       juce::jmin(maxPieceSize, numSamples - offset));
+                process(subBlock);
+            }
+
+            return;
+        }
+
+        if (oversampling.isSelected())
+        {
+            //everything from here on, dry or wet, runs on the delayed signal; the oversampled path
+            //starts from the undelayed copy and picks up the same delay in its filters
+            oversampling.delay(buffer, (oversamplingEngaged || rateFadeSamplesRemaining > 0) && !linearPhase);
+        }
+
+        if (!isEngaged && !wetGain.isSmoothing() && deterministic)
+        {
+            //where the filters stop would depend on where the blocks fall, so they run on underneath the dry signal
+            processUnderDry(buffer);
+            return;
+        }
+
+        if (!isEngaged && !wetGain.isSmoothing())
+        {
+            //fully disengaged: the input passes through untouched and the filters start clean on re-engage
+            if (!isIdle)
+            {
+                resetFilters();
+                isIdle = true;
+            }
+
+            silentSamples = 0;
+            return;
+        }
+
+        //skipping silence depends on where the blocks fall too, so a deterministic render never does
+        if (!deterministic && isInputSilent(buffer))
+        {
+            silentSamples += numSamples;
+
+            if (silentSamples > tailLengthInSamples)
+            {
+                //the filters have rung out, so there is nothing left to compute until the input comes back
+                if (!isIdle)
+                {
+                    resetFilters();
+                    isIdle = true;
+                }
+
+                wetGain.skip(numSamples);
+                buffer.clear();
+                return;
+            }
+        }
+        else
+        {
+            silentSamples = 0;
+        }
+
+        isIdle = false;
+
+        //a block larger than the prepared size can't be crossfaded, so it switches immediately
+        const bool shouldCrossfade = wetGain.isSmoothing()
+                                  && numSamples <= dryBuffer.getNumSamples()
+                                  && buffer.getNumChannels() <= dryBuffer.getNumChannels();
+
+        if (shouldCrossfade)
+        {
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                dryBuffer.copyFrom(channel, 0, buffer, channel, 0, numSamples);
+        }
+        else
+        {
+            wetGain.skip(numSamples);
+        }
+
+        processWet(buffer);
+
+        if (shouldCrossfade)
+            crossfadeWithDry(buffer);
+    }
+
+private:
+    void resetFilters()
+    {
+        resetCascades();
+        rateFadeSamplesRemaining = 0;
+
+        if (linearPhaseEQ != nullptr)
+            linearPhaseEQ->reset();
+
+        linearPhaseDelay.reset();
+        oversampling.resetOversampler();
+    }
+
+    /** Hands the biquad sections to the cascades of the current topology. The parallel
+        form is expanded once for every group, and falls back to the serial cascade when
+        the expansion doesn't hold up.
+    */
+    void setBiquadSections(double designRate, int rampLengthInSamples)
+    {
+        if (topology == Topology_Parallel)
+        {
+            const auto expanded = ParallelForm::expand(sections, expansion, designRate, ParallelForm::getMaxGainSpread<SampleType>());
+
+            for (auto& cascade : parallelCascades)
+                cascade.setSections(sections, expanded ? &expansion : nullptr, designRate, rampLengthInSamples);
+        }
+        else
+        {
+            for (auto& cascade : cascades)
+                cascade.setSections(sections, rampLengthInSamples);
+        }
+    }
+
+    /** Brings the mode, oversampling and engagement in line with the settings, the part every update shares.
+        Returns the rate to design for, and scales the ramp to it. A morphed update passes its snapshots and
+        segment along, so the linear-phase kernel blends the same sections the cascades do.
+    */
+    double beginUpdate(const ChainSettings& chainSettings, double sampleRate, int& rampLengthInSamples,
+                       const SnapshotMorph::Snapshots* snapshots = nullptr, const SnapshotMorph::Segment* segment = nullptr)
+    {
+        //the processor enables the linear-phase EQ from the message thread; until then the IIR path stands in
+        const bool shouldUseLinearPhase = chainSettings.linearPhase && linearPhaseEQ != nullptr && linearPhaseEQ->isEnabled();
+
+        if (shouldUseLinearPhase != linearPhase || chainSettings.processingMode != processingMode || chainSettings.topology != topology)
+        {
+            //whichever path takes over starts from a clean state
+            resetFilters();
+            linearPhase = shouldUseLinearPhase;
+            processingMode = chainSettings.processingMode;
+
+            //the other topology's sections were designed from older settings, so redesign them all
+            if (chainSettings.topology != topology)
+                designedSampleRate = 0.0;
+
+            topology = chainSettings.topology;
+        }
+
+        if (linearPhase)
+        {
+            LinearPhaseEQ::KernelRequest request{ chainSettings };
+
+            if (snapshots != nullptr && segment != nullptr)
+            {
+                request.morphed = true;
+                request.morphFrom = snapshots->settings[(size_t)segment->from];
+                request.morphTo = snapshots->settings[(size_t)segment->to];
+                request.morphAmount = segment->amount;
+            }
+
+            linearPhaseEQ->setSettings(request);
+        }
+
+        //the cascades taking over from the other rate start clean, so they start on their design too
+        if (updateOversampling(chainSettings, sampleRate))
+            rampLengthInSamples = 0;
+
+        //with the oversampler engaged the sections are designed for, and ramp over, the oversampled rate
+        const auto factor = oversamplingEngaged ? oversampling.getFactor() : 1;
+        rampLengthInSamples *= factor;
+
+        //the linear-phase path never disengages: its bypass is a pure delay, which keeps the latency constant
+        isEngaged = linearPhase || !(chainSettings.globalBypassed || isTransparent(chainSettings));
+        wetGain.setTargetValue(isEngaged ? SampleType(1) : SampleType(0));
+
+        return sampleRate * factor;
+    }
+
+    /** Follows the oversampling mode and decides whether the oversampler should be
+        engaged, which it is only while some band sits above the threshold. Returns
+        true when it has just engaged or disengaged.
+    */
+    bool updateOversampling(const ChainSettings& chainSettings, double sampleRate)
+    {
+        //the linear-phase path has no use for it
+        const auto factor = linearPhase ? Oversampling_Off : chainSettings.oversamplingFactor;
+
+        if (oversampling.setMode(factor, chainSettings.oversamplingFilter))
+            designedSampleRate = 0.0;
+
+        const auto threshold = chainSettings.oversamplingThreshold * 0.5 * sampleRate * (oversamplingEngaged ? oversamplingHysteresis : 1.0);
+        const bool shouldEngage = oversampling.isSelected() && getHighestActiveFrequency(chainSettings) > threshold;
+
+        if (shouldEngage == oversamplingEngaged)
+            return false;
+
+        if (oversampling.isSelected() && !linearPhase)
+        {
+            //the outgoing rate's filters keep running under a crossfade, while the ones for the
+            //new rate start clean; the half-band filters only ever serve the oversampled side
+            swapWithOutgoingCascades();
+            resetCascades();
+
+            if (shouldEngage)
+                oversampling.resetOversampler();
+
+            rateFadeSamplesRemaining = rateFadeLength;
+        }
+        else
+        {
+            //switching the mode off resets the oversampler anyway, and the linear-phase path doesn't use it
+            resetFilters();
+        }
+
+        oversamplingEngaged = shouldEngage;
+        designedSampleRate = 0.0;
+        return true;
+    }
+
+    void resetCascades()
+    {
+        for (auto& cascade : cascades)
+            cascade.reset();
+
+        for (auto& cascade : svfCascades)
+            cascade.reset();
+
+        for (auto& cascade : parallelCascades)
+            cascade.reset();
+    }
+
+    void swapWithOutgoingCascades()
+    {
+        std::swap(cascades, outgoingCascades);
+        std::swap(svfCascades, outgoingSvfCascades);
+        std::swap(parallelCascades, outgoingParallelCascades);
+    }
+
+    void processWet(juce::AudioBuffer<SampleType>& buffer)
+    {
+        if (rateFadeSamplesRemaining > 0)
+            processChainsCrossfadingRate(buffer);
+        else
+            processChains(buffer);
+    }
+
+    /** Runs the outgoing rate's path on a copy of the block and the incoming one in place, then
+        fades from the one to the other.
+    */
+    void processChainsCrossfadingRate(juce::AudioBuffer<SampleType>& buffer)
+    {
+        const auto numSamples = buffer.getNumSamples();
+        const auto numChannels = buffer.getNumChannels();
+        jassert(numSamples <= rateFadeBuffer.getNumSamples() && numChannels <= rateFadeBuffer.getNumChannels());
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            rateFadeBuffer.copyFrom(channel, 0, buffer, channel, 0, numSamples);
+
+        juce::AudioBuffer<SampleType> outgoing(rateFadeBuffer.getArrayOfWritePointers(), numChannels, numSamples);
+
+        swapWithOutgoingCascades();
+        oversamplingEngaged = !oversamplingEngaged;
+        processChains(outgoing);
+        oversamplingEngaged = !oversamplingEngaged;
+        swapWithOutgoingCascades();
+
+        processChains(buffer);
+
+        const auto fadeSamples = juce::jmin(numSamples, rateFadeSamplesRemaining);
+        const auto first = rateFadeLength - rateFadeSamplesRemaining;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* incoming = buffer.getWritePointer(channel);
+            const auto* faded = outgoing.getReadPointer(channel);
+
+            for (int i = 0; i < fadeSamples; ++i)
+            {
+                const auto gain = SampleType(first + i + 1) / SampleType(rateFadeLength);
+                incoming[i] = faded[i] + gain * (incoming[i] - faded[i]);
+            }
+        }
+
+        rateFadeSamplesRemaining -= fadeSamples;
+    }
+
+    void processChains(juce::AudioBuffer<SampleType>& buffer)
+    {
+        const auto numSamples = buffer.getNumSamples();
+        const bool hasSecondChannel = buffer.getNumChannels() > 1;
+        const bool isMidSide = hasSecondChannel && (processingMode == Mode_Mid || processingMode == Mode_Side);
+
+        //stereo mode equalises every channel of the bus; the other modes pick one channel of the
+        //first pair, where in mid/side mode the first channel carries mid and the second carries side
+        int startChannel = 0;
+        int numChannels = buffer.getNumChannels();
+
+        if (processingMode != Mode_Stereo)
+        {
+            const bool usesSecond = processingMode == Mode_Right || processingMode == Mode_Side;
+            startChannel = usesSecond ? 1 : 0;
+            numChannels = (usesSecond && !hasSecondChannel) ? 0 : 1;
+        }
+
+        const bool isOversampled = oversamplingEngaged && !linearPhase && numChannels > 0;
+
+        //the cascades convert to mid/side and back as they gather and scatter the channel they filter;
+        //the resampler, the convolver and a crossfade between parallel forms need it done in the buffer
+        if (isMidSide && !linearPhase && !isOversampled
+            && !(topology == Topology_Parallel && parallelCascades.front().isCrossfadingForms()))
+        {
+            processMidSide(buffer, processingMode == Mode_Side);
+            return;
+        }
+
+        if (isMidSide)
+        {
+            encodeMidSide(buffer.getWritePointer(0), buffer.getWritePointer(1), numSamples);
+
+            if (isOversampled)
+                encodeMidSide(oversampling.getInput().getWritePointer(0), oversampling.getInput().getWritePointer(1), numSamples);
+        }
+
+        if (linearPhase)
+            processLinearPhase(buffer, startChannel, numChannels);
+        else if (isOversampled)
+            processOversampled(buffer, startChannel, numChannels);
+        else if (numChannels > 0)
+            processCascades(buffer, startChannel, numChannels);
+
+        if (isMidSide)
+            decodeMidSide(buffer.getWritePointer(0), buffer.getWritePointer(1), numSamples);
+    }
+
+    /** Runs every group that overlaps the channel range, in parallel when the
+        block is expensive enough to pay for the hand-off and serially otherwise.
+        The serial runs keep a running estimate of the cost per channel-sample,
+        which is what the decision is based on.
+    */
+    void processCascades(juce::AudioBuffer<SampleType>& buffer, int startChannel, int numChannels)
+    {
+        cascadeJob.buffer = &buffer;
+        cascadeJob.startChannel = startChannel;
+        cascadeJob.endChannel = startChannel + numChannels;
+
+        const auto firstGroup = startChannel / channelsPerGroup;
+        const auto lastGroup = juce::jmin((int)cascades.size() - 1, (cascadeJob.endChannel - 1) / channelsPerGroup);
+        const auto numGroups = lastGroup - firstGroup + 1;
+        cascadeJob.firstGroup = firstGroup;
+
+        const auto channelSamples = double(numChannels) * buffer.getNumSamples();
+
+        if (useWorkerPool && workerPool != nullptr && numGroups > 1
+            && secondsPerChannelSample * channelSamples > parallelCostRatio * workerPool->getDispatchOverheadSeconds()
+            && workerPool->run(cascadeJob, numGroups))
+        {
+            return;
+        }
+
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+
+        for (int group = 0; group < numGroups; ++group)
+            cascadeJob.runTask(group);
+
+        const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+        const auto measured = seconds / juce::jmax(1.0, channelSamples);
+        secondsPerChannelSample = secondsPerChannelSample > 0.0 ? 0.9 * secondsPerChannelSample + 0.1 * measured : measured;
+    }
+
+    void processMidSide(juce::AudioBuffer<SampleType>& buffer, bool filterSide)
+    {
+        if (topology == Topology_SVF)
+            svfCascades.front().processMidSide(buffer, filterSide);
+        else if (topology == Topology_Parallel)
+            parallelCascades.front().processMidSide(buffer, filterSide);
+        else
+            cascades.front().processMidSide(buffer, filterSide);
+    }
+
+    /** Filters the undelayed copy of the channels at the oversampled rate, writing over the delayed ones. */
+    void processOversampled(juce::AudioBuffer<SampleType>& buffer, int startChannel, int numChannels)
+    {
+        auto oversampled = oversampling.upsample(startChannel, numChannels, buffer.getNumSamples());
+        processCascades(oversampled, 0, numChannels);
+        oversampling.downsample(buffer, startChannel, numChannels);
+    }
+
+    void processLinearPhase(juce::AudioBuffer<SampleType>& buffer, int startChannel, int numChannels)
+    {
+        if (numChannels > 0)
+            convolve(buffer, startChannel, numChannels);
+
+        //a channel that isn't being equalised is only delayed by the convolution latency
+        linearPhaseDelay.setDelay(static_cast<SampleType>(linearPhaseEQ->getLatencyInSamples()));
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            if (channel >= startChannel && channel < startChannel + numChannels)
+                continue;
+
+            auto* samples = buffer.getWritePointer(channel);
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                linearPhaseDelay.pushSample(channel, samples[i]);
+                samples[i] = linearPhaseDelay.popSample(channel);
+            }
+        }
+    }
+
+    void convolve(juce::AudioBuffer<SampleType>& buffer, int startChannel, int numChannels)
+    {
+        const auto numSamples = buffer.getNumSamples();
+
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            auto block = juce::dsp::AudioBlock<float>(buffer).getSubsetChannelBlock((size_t)startChannel, (size_t)numChannels);
+            juce::dsp::ProcessContextReplacing<float> context(block);
+            linearPhaseEQ->process(context);
+        }
+        else
+        {
+            jassert(numSamples <= linearPhaseBuffer.getNumSamples());
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto* src = buffer.getReadPointer(startChannel + channel);
+                auto* dst = linearPhaseBuffer.getWritePointer(channel);
+
+                for (int i = 0; i < numSamples; ++i)
+                    dst[i] = static_cast<float>(src[i]);
+            }
+
+            auto block = juce::dsp::AudioBlock<float>(linearPhaseBuffer).getSubsetChannelBlock(0, (size_t)numChannels)
+                                                                      .getSubBlock(0, (size_t)numSamples);
+            juce::dsp::ProcessContextReplacing<float> context(block);
+            linearPhaseEQ->process(context);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto* src = linearPhaseBuffer.getReadPointer(channel);
+                auto* dst = buffer.getWritePointer(startChannel + channel);
+
+                for (int i = 0; i < numSamples; ++i)
+                    dst[i] = static_cast<SampleType>(src[i]);
+            }
+        }
+    }
+
+    /** Runs the filters on the block and then puts the dry signal back, for a deterministic render that is disengaged. */
+    void processUnderDry(juce::AudioBuffer<SampleType>& buffer)
+    {
+        const auto numSamples = buffer.getNumSamples();
+        const auto numChannels = juce::jmin(buffer.getNumChannels(), dryBuffer.getNumChannels());
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            dryBuffer.copyFrom(channel, 0, buffer, channel, 0, numSamples);
+
+        processWet(buffer);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            buffer.copyFrom(channel, 0, dryBuffer, channel, 0, numSamples);
+
+        isIdle = false;
+    }
+
+    void crossfadeWithDry(juce::AudioBuffer<SampleType>& buffer)
+    {
+        const auto numChannels = buffer.getNumChannels();
+        auto* const* wet = buffer.getArrayOfWritePointers();
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            const auto gain = wetGain.getNextValue();
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                const auto dry = dryBuffer.getSample(channel, i);
+                wet[channel][i] = dry + gain * (wet[channel][i] - dry);
+            }
+        }
+    }
+
+    struct CascadeJob : ChannelWorkerPool::Job
+    {
+        explicit CascadeJob(EQEngine& e) : engine(e) {}
+
+        void runTask(int taskIndex) override
+        {
+            const auto group = firstGroup + taskIndex;
+            const auto begin = juce::jmax(startChannel, group * engine.channelsPerGroup);
+            const auto end = juce::jmin(endChannel, (group + 1) * engine.channelsPerGroup);
+
+            if (engine.topology == Topology_SVF)
+                engine.svfCascades[(size_t)group].process(*buffer, begin, end - begin);
+            else if (engine.topology == Topology_Parallel)
+                engine.parallelCascades[(size_t)group].process(*buffer, begin, end - begin);
+            //a lone channel would leave most of the cascade's lanes empty, so it is vectorised across time instead
+            else if (end - begin == 1)
+                engine.cascades[(size_t)group].processSingleChannel(*buffer, begin);
+            else
+                engine.cascades[(size_t)group].process(*buffer, begin, end - begin);
+        }
+
+        EQEngine& engine;
+        juce::AudioBuffer<SampleType>* buffer = nullptr;
+        int startChannel = 0, endChannel = 0, firstGroup = 0;
+    };
+
+    int channelsPerGroup = maxChannelsPerGroup;
+    std::vector<EQCascade<SampleType>> cascades;
+    EQSectionList<SampleType> sections;
+
+    std::vector<EQSVFCascade<SampleType>> svfCascades;
+    EQSVFSectionList<SampleType> svfSections;
+
+    std::vector<EQParallelCascade<SampleType>> parallelCascades;
+
+    //the other rate's cascades, run under the crossfade after the oversampler engages or disengages
+    std::vector<EQCascade<SampleType>> outgoingCascades;
+    std::vector<EQSVFCascade<SampleType>> outgoingSvfCascades;
+    std::vector<EQParallelCascade<SampleType>> outgoingParallelCascades;
+    juce::AudioBuffer<SampleType> rateFadeBuffer;
+    int rateFadeLength = 1, rateFadeSamplesRemaining = 0;
+    ParallelForm::Expansion<MaxSections> expansion;
+    PeakCoefficientTable peakTable;
+
+    FilterTopology topology = Topology_Biquad;
+    ChainSettings designedSettings;
+    double designedSampleRate = 0.0;
+
+    std::array<EQSectionList<double>, SnapshotMorph::maxSnapshots> snapshotSections;
+    juce::uint32 designedSnapshotGeneration = 0;
+    double designedSnapshotRate = 0.0;
+
+    ChannelWorkerPool* workerPool = nullptr;
+    CascadeJob cascadeJob{ *this };
+    bool useWorkerPool = false;
+    double secondsPerChannelSample = 0.0;
+
+    bool deterministic = false;
+
+    LinearPhaseEQ* linearPhaseEQ = nullptr;
+    juce::AudioBuffer<float> linearPhaseBuffer;
+    juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::None> linearPhaseDelay;
+    bool linearPhase = false;
+
+    ProcessingMode processingMode = Mode_Stereo;
+
+    OversamplingStage<SampleType> oversampling;
+    bool oversamplingEngaged = false;
+
+    juce::AudioBuffer<SampleType> dryBuffer;
+    juce::SmoothedValue<SampleType> wetGain;
+    bool isEngaged = true;
+
+    int tailLengthInSamples = 0;
+    int silentSamples = 0;
+    bool isIdle = false;
+
+    static bool isInputSilent(const juce::AudioBuffer<SampleType>& buffer)
+    {
+        const auto threshold = juce::Decibels::decibelsToGain(static_cast<SampleType>(silenceThresholdInDecibels),
+                                                              static_cast<SampleType>(silenceThresholdInDecibels - 1.0));
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            if (buffer.getMagnitude(channel, 0, buffer.getNumSamples()) > threshold)
+                return false;
+        }
+
+        return true;
+    }
+
+    int computeTailLengthInSamples() const
+    {
+        if (linearPhase)
+            return linearPhaseEQ->getKernelSize() + LinearPhaseEQ::partitionSize;
+
+        if (cascades.empty())
+            return 0;
+
+        //every group runs the same sections, whose decay is counted at the rate they run at
+        const auto decay = topology == Topology_SVF      ? getCascadeDecayLength(svfCascades.front())
+                         : topology == Topology_Parallel ? getCascadeDecayLength(parallelCascades.front())
+                                                         : getCascadeDecayLength(cascades.front());
+
+        return decay / (oversamplingEngaged ? oversampling.getFactor() : 1) + oversampling.getLatencyInSamples();
+    }
+
+    template<typename CascadeType>
+    static int getCascadeDecayLength(const CascadeType& cascade)
+    {
+        int tail = 0;
+
+        for (int index = 0; index < cascade.getNumActiveSlots(); ++index)
+            tail += getDecayLengthInSamples(cascade.getActiveCoefficients(index).toBiquad(), silenceThresholdInDecibels);
+
+        return tail;
+    }
+};
@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+    FFTBackend.cpp
+
+  ==============================================================================
+*/
+
+#include "FFTBackend.h"
+#include "KernelDispatch.h"
+#include <vector>
+
+namespace
+{
+    class JuceFFTBackend : public FFTBackend
+    {
+    public:
+        explicit JuceFFTBackend(int fftOrder) : FFTBackend(fftOrder), fft(fftOrder) {}
+
+        void performMagnitudeTransform(float* data) override
+        {
+            fft.performFrequencyOnlyForwardTransform(data);
+        }
+
+    private:
+        juce::dsp::FFT fft;
+    };
+
+    /** A real transform of size N done as a complex one of size N / 2, with the even samples as the real
+        parts and the odd ones as the imaginary parts, then unpacked into the N / 2 + 1 bins. The complex
+        transform keeps its real and imaginary parts in separate arrays, so each radix-2 pass is a plain
+        loop over whole runs of points that the spectrum kernels vectorise.
+    */
+    class BundledFFTBackend : public FFTBackend
+    {
+    public:
+        explicit BundledFFTBackend(int fftOrder)
+            : FFTBackend(fftOrder), numPoints(getSize() / 2)
+        {
+            jassert(fftOrder >= 2);
+
+            real.resize((size_t)numPoints);
+            imag.resize((size_t)numPoints);
+            reversed.resize((size_t)numPoints);
+
+            const auto bits = order - 1;
+
+            for (int point = 0; point < numPoints; ++point)
+            {
+                int position = 0;
+
+                for (int bit = 0; bit < bits; ++bit)
+                    position |= ((point >> bit) & 1) << (bits - 1 - bit);
+
+                reversed[(size_t)point] = position;
+            }
+
+            //the twiddles of each pass follow one another, halfSpan of them starting at halfSpan - 1
+            twiddleReal.resize((size_t)numPoints);
+            twiddleImag.resize((size_t)numPoints);
+
+            for (int halfSpan = 1; halfSpan < numPoints; halfSpan *= 2)
+            {
+                for (int i = 0; i < halfSpan; ++i)
+                {
+                    const auto angle = -juce::MathConstants<double>::pi * i / halfSpan;
+                    twiddleReal[(size_t)(halfSpan - 1 + i)] = static_cast<float>(std::cos(angle));
+                    twiddleImag[(size_t)(halfSpan - 1 + i)] = static_cast<float>(std::sin(angle));
+                }
+            }
+
+            unpackReal.resize((size_t)numPoints);
+            unpackImag.resize((size_t)numPoints);
+
+            for (int bin = 0; bin < numPoints; ++bin)
+            {
+                const auto angle = -juce::MathConstants<double>::twoPi * bin / getSize();
+                unpackReal[(size_t)bin] = static_cast<float>(std::cos(angle));
+                unpackImag[(size_t)bin] = static_cast<float>(std::sin(angle));
+            }
+        }
+
+        void performMagnitudeTransform(float* data) override
+        {
+            for (int point = 0; point < numPoints; ++point)
+            {
+                const auto position = (size_t)reversed[(size_t)point];
+                real[position] = data[2 * point];
+                imag[position] = data[2 * point + 1];
+            }
+
+            const auto& kernels = KernelDispatch::getSpectrumKernels();
+
+            for (int halfSpan = 1; halfSpan < numPoints; halfSpan *= 2)
+                kernels.fftButterflies(real.data(), imag.data(), twiddleReal.data() + halfSpan - 1, twiddleImag.data() + halfSpan - 1,
+                                       numPoints, halfSpan);
+
+            //bin k comes from points k and N / 2 - k: half their sum is the even samples' spectrum and half
+            //their difference, turned a quarter, the odd samples', which is shifted by the unpacking twiddle
+            data[0] = std::abs(real[0] + imag[0]);
+            data[numPoints] = std::abs(real[0] - imag[0]);
+
+            for (int bin = 1; bin < numPoints; ++bin)
+            {
+                const auto mirror = (size_t)(numPoints - bin);
+                const auto k = (size_t)bin;
+
+                const auto evenReal = 0.5f * (real[k] + real[mirror]);
+                const auto evenImag = 0.5f * (imag[k] - imag[mirror]);
+                const auto oddReal = 0.5f * (imag[k] + imag[mirror]);
+                const auto oddImag = -0.5f * (real[k] - real[mirror]);
+
+                const auto binReal = evenReal + unpackReal[k] * oddReal - unpackImag[k] * oddImag;
+                const auto binImag = evenImag + unpackReal[k] * oddImag + unpackImag[k] * oddReal;
+                data[bin] = std::sqrt(binReal * binReal + binImag * binImag);
+            }
+        }
+
+    private:
+        const int numPoints;
+        std::vector<float> real, imag, twiddleReal, twiddleImag, unpackReal, unpackImag;
+        std::vector<int> reversed;
+    };
+
+    FFTBackendType chooseType()
+    {
+        const auto requested = juce::SystemStats::getEnvironmentVariable(FFTBackend::backendEnvironmentVariable, {}).trim().toLowerCase();
+
+        if (requested.isNotEmpty())
+        {
+            for (int type = 0; type < NumFFTBackendTypes; ++type)
+            {
+                if (requested == FFTBackend::getTypeName((FFTBackendType)type))
+                    return (FFTBackendType)type;
+            }
+
+            DBG("Ignoring " << FFTBackend::backendEnvironmentVariable << "=" << requested << ", which names no FFT backend");
+        }
+
+        return SIMPLEEQ_FFT_BACKEND;
+    }
+}
+
+FFTBackendType FFTBackend::getActiveType()
+{
+    static const auto type = chooseType();
+    return type;
+}
+
+const char* FFTBackend::getTypeName(FFTBackendType type)
+{
+    switch (type)
+    {
+    case FFTBackend_Bundled:    return "bundled";
+    case FFTBackend_Juce:
+    default:                    return "juce";
+    }
+}
+
+std::unique_ptr<FFTBackend> FFTBackend::create(FFTBackendType type, int order)
+{
+    if (type == FFTBackend_Bundled)
+        return std::make_unique<BundledFFTBackend>(order);
+
+    return std::make_unique<JuceFFTBackend>(order);
+}
@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    FFTBackend.h
+    The transform behind the analyzer, behind one small interface so the
+    implementation can be chosen per build or per run. One backend wraps
+    juce::dsp::FFT, which is fast wherever JUCE has a platform FFT to call
+    into and slow on its own fallback; the other is a real-input radix-2 FFT
+    bundled with the plugin, whose butterflies run on the dispatched
+    spectrum kernels.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+
+enum FFTBackendType
+{
+    FFTBackend_Juce,
+    FFTBackend_Bundled,
+    NumFFTBackendTypes
+};
+
+//the backend used unless the environment variable names another, e.g. -DSIMPLEEQ_FFT_BACKEND=FFTBackend_Juce.
+//JUCE's own FFT is the default only where it has a platform implementation behind it
+#ifndef SIMPLEEQ_FFT_BACKEND
+ #if JUCE_MAC || JUCE_IOS || JUCE_DSP_USE_INTEL_MKL || JUCE_DSP_USE_SHARED_FFTW || JUCE_DSP_USE_STATIC_FFTW
+  #define SIMPLEEQ_FFT_BACKEND FFTBackend_Juce
+ #else
+  #define SIMPLEEQ_FFT_BACKEND FFTBackend_Bundled
+ #endif
+#endif
+
+class FFTBackend
+{
+public:
+    virtual ~FFTBackend() = default;
+
+    int getSize() const { return 1 << order; }
+
+    /** Takes getSize() real samples from the start of data, which has room for 2 * getSize() values,
+        and replaces them with the magnitudes of bins 0 to getSize() / 2, unscaled. Anything after
+        those bins is left undefined.
+    */
+    virtual void performMagnitudeTransform(float* data) = 0;
+
+    //names a backend for the override, e.g. SIMPLEEQ_FFT_BACKEND=juce
+    static constexpr const char* backendEnvironmentVariable = "SIMPLEEQ_FFT_BACKEND";
+
+    /** The backend create() uses, picked on first use: the one the environment variable names ("juce"
+        or "bundled"), or SIMPLEEQ_FFT_BACKEND when it names none.
+    */
+    static FFTBackendType getActiveType();
+
+    static const char* getTypeName(FFTBackendType type);
+
+    static std::unique_ptr<FFTBackend> create(FFTBackendType type, int order);
+
+    /** A transform of the active backend. */
+    static std::unique_ptr<FFTBackend> create(int order) { return create(getActiveType(), order); }
+
+protected:
+    explicit FFTBackend(int fftOrder) : order(fftOrder) {}
+
+    const int order;
+};
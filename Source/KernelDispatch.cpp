@@ -0,0 +1,173 @@
+/*
+  ==============================================================================
+
+    KernelDispatch.cpp
+
+  ==============================================================================
+*/
+
+#include "KernelVariants.h"
+#include <atomic>
+
+//the deterministic variant never fuses a multiply and an add. GCC contracts whenever the target has FMA,
+//so it is told not to for those functions alone. Clang only contracts within an expression and MSVC's
+//default /fp:precise not at all, so the generic build, which has no FMA, is already unfused there; a
+//Clang build whose baseline does have FMA turns contraction off for the whole file instead
+#if defined(__GNUC__) && !defined(__clang__)
+ #define SIMPLEEQ_KERNEL_UNFUSED __attribute__((optimize("fp-contract=off")))
+#else
+ #define SIMPLEEQ_KERNEL_UNFUSED
+ #if defined(__clang__) && defined(__FMA__)
+  #pragma clang fp contract(off)
+ #endif
+#endif
+
+namespace
+{
+    SIMPLEEQ_DEFINE_KERNEL_VARIANT(GenericKernels, )
+    SIMPLEEQ_DEFINE_KERNEL_VARIANT(DeterministicKernels, SIMPLEEQ_KERNEL_UNFUSED)
+
+    /** The kernels of every variant, the generic ones standing in for any the build left out. */
+    struct BuiltVariants
+    {
+        BuiltVariants()
+        {
+            kernels.fill(GenericKernels::getKernels());
+            built[Isa_Generic] = true;
+            built[Isa_SSE42] = KernelDispatch::getSSE42Kernels(kernels[Isa_SSE42]);
+            built[Isa_AVX2] = KernelDispatch::getAVX2Kernels(kernels[Isa_AVX2]);
+            built[Isa_AVX512] = KernelDispatch::getAVX512Kernels(kernels[Isa_AVX512]);
+        }
+
+        std::array<KernelDispatch::VariantKernels, NumKernelIsas> kernels;
+        std::array<bool, NumKernelIsas> built{};
+    };
+
+    const BuiltVariants& getBuiltVariants()
+    {
+        static const BuiltVariants variants;
+        return variants;
+    }
+
+    std::atomic<int>& getActiveIsaHolder()
+    {
+        static std::atomic<int> isa{ (int)KernelDispatch::chooseIsa() };
+        return isa;
+    }
+}
+
+namespace KernelDispatch
+{
+    KernelIsa getActiveIsa()
+    {
+        return (KernelIsa)getActiveIsaHolder().load(std::memory_order_relaxed);
+    }
+
+    bool setActiveIsa(KernelIsa isa)
+    {
+        if (!isSupported(isa))
+            return false;
+
+        getActiveIsaHolder().store((int)isa, std::memory_order_relaxed);
+        return true;
+    }
+
+    KernelIsa chooseIsa()
+    {
+        const auto requested = juce::SystemStats::getEnvironmentVariable(isaEnvironmentVariable, {}).trim().toLowerCase();
+
+        if (requested.isNotEmpty())
+        {
+            for (int isa = 0; isa < NumKernelIsas; ++isa)
+            {
+                if (requested == getIsaName((KernelIsa)isa) && isSupported((KernelIsa)isa))
+                    return (KernelIsa)isa;
+            }
+
+            DBG("Ignoring " << isaEnvironmentVariable << "=" << requested << ", which this build or CPU doesn't support");
+        }
+
+        for (int isa = NumKernelIsas - 1; isa > Isa_Generic; --isa)
+        {
+            if (isSupported((KernelIsa)isa))
+                return (KernelIsa)isa;
+        }
+
+        return Isa_Generic;
+    }
+
+    bool isSupported(KernelIsa isa)
+    {
+        if (!juce::isPositiveAndBelow((int)isa, (int)NumKernelIsas) || !getBuiltVariants().built[(size_t)isa])
+            return false;
+
+        switch (isa)
+        {
+        case Isa_SSE42:     return juce::SystemStats::hasSSE42();
+        case Isa_AVX2:      return juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3();
+        case Isa_AVX512:    return juce::SystemStats::hasAVX512F() && juce::SystemStats::hasAVX512VL();
+        case Isa_Generic:
+        default:            return true;
+        }
+    }
+
+    int getVectorBytes(KernelIsa isa)
+    {
+        switch (isa)
+        {
+        case Isa_SSE42:     return 16;
+        case Isa_AVX2:      return 32;
+        case Isa_AVX512:    return 64;
+        case Isa_Generic:
+        default:            return (int)(juce::dsp::SIMDRegister<float>::SIMDNumElements * sizeof(float));
+        }
+    }
+
+    const char* getIsaName(KernelIsa isa)
+    {
+        switch (isa)
+        {
+        case Isa_SSE42:     return "sse4.2";
+        case Isa_AVX2:      return "avx2";
+        case Isa_AVX512:    return "avx512";
+        case Isa_Generic:
+        default:            return "generic";
+        }
+    }
+
+    template<typename SampleType>
+    const FilterKernels<SampleType>& getFilterKernels(KernelIsa isa)
+    {
+        return getFilters<SampleType>(getBuiltVariants().kernels[(size_t)juce::jlimit(0, NumKernelIsas - 1, (int)isa)]);
+    }
+
+    template<typename SampleType>
+    const FilterKernels<SampleType>& getFilterKernels()
+    {
+        return getFilterKernels<SampleType>(getActiveIsa());
+    }
+
+    template<typename SampleType>
+    const FilterKernels<SampleType>& getDeterministicFilterKernels()
+    {
+        static const VariantKernels kernels = DeterministicKernels::getKernels();
+        return getFilters<SampleType>(kernels);
+    }
+
+    template const FilterKernels<float>& getFilterKernels<float>(KernelIsa);
+    template const FilterKernels<double>& getFilterKernels<double>(KernelIsa);
+    template const FilterKernels<float>& getFilterKernels<float>();
+    template const FilterKernels<double>& getFilterKernels<double>();
+    template const FilterKernels<float>& getDeterministicFilterKernels<float>();
+    template const FilterKernels<double>& getDeterministicFilterKernels<double>();
+
+    const SpectrumKernels& getSpectrumKernels(KernelIsa isa)
+    {
+        return getBuiltVariants().kernels[(size_t)juce::jlimit(0, NumKernelIsas - 1, (int)isa)].spectrum;
+    }
+
+    const SpectrumKernels& getSpectrumKernels()
+    {
+        return getSpectrumKernels(getActiveIsa());
+    }
+}
@@ -0,0 +1,120 @@
+/*
+  ==============================================================================
+
+    KernelDispatch.h
+    The inner loops of the filter engine and the analyzer, compiled once for
+    each instruction set in KernelIsa and chosen once per process from what
+    the CPU reports, so a single binary runs the widest vectors every machine
+    in a mixed fleet has. The loops themselves are written once, as the plain
+    code the rest of the engine uses; only the instruction set they are built
+    for differs between the variants. Each variant other than the generic one
+    lives in its own KernelDispatch<isa>.cpp, so MSVC, which can only target an
+    instruction set per file, builds them too; see KernelVariants.h.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//the kernel bodies have to be inlined into every variant for its target to apply to them, so they are
+//always inlined, even in debug builds, where JUCE's forcedinline is only a hint
+#if defined(__GNUC__) || defined(__clang__)
+ #define SIMPLEEQ_KERNEL_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+ #define SIMPLEEQ_KERNEL_INLINE __forceinline
+#else
+ #define SIMPLEEQ_KERNEL_INLINE inline
+#endif
+
+template<typename SampleType> struct BiquadCoefficients;
+template<typename SampleType> struct BiquadBlockKernel;
+
+enum KernelIsa
+{
+    Isa_Generic,
+    Isa_SSE42,
+    Isa_AVX2,       //with FMA3
+    Isa_AVX512,     //F and VL
+    NumKernelIsas
+};
+
+namespace KernelDispatch
+{
+    template<typename SampleType>
+    struct FilterKernels
+    {
+        /** Runs numFrames frames of interleaved lanes through one TDF2 section with fixed coefficients. */
+        void (*biquadFrames)(SampleType* frames, SampleType* s1, SampleType* s2, int lanes, int numFrames,
+                             const BiquadCoefficients<SampleType>& c);
+
+        /** Runs numBlocks whole blocks of one channel through a section's block state-space kernel. */
+        void (*biquadBlocks)(SampleType* samples, SampleType& s1, SampleType& s2, int numBlocks,
+                             const BiquadBlockKernel<SampleType>& kernel);
+    };
+
+    struct SpectrumKernels
+    {
+        /** Multiplies the samples by the window. */
+        void (*applyWindow)(float* samples, const float* window, int numSamples);
+
+        /** Scales the magnitudes of the bins and converts them to decibels, floored at negativeInfinity. */
+        void (*magnitudesToDecibels)(float* bins, int numBins, float scale, float negativeInfinity);
+
+        /** One radix-2 pass of an in-place complex FFT held as separate real and imaginary arrays: every
+            span of 2 * halfSpan points combines its halves with the halfSpan twiddles of the pass.
+        */
+        void (*fftButterflies)(float* real, float* imag, const float* twiddleReal, const float* twiddleImag, int size, int halfSpan);
+    };
+
+    //names a variant for the override, e.g. SIMPLEEQ_KERNEL_ISA=sse4.2
+    static constexpr const char* isaEnvironmentVariable = "SIMPLEEQ_KERNEL_ISA";
+
+    /** The variant every kernel runs on, picked on first use: the widest one both the build and the CPU
+        support, unless the environment variable names another supported one ("generic", "sse4.2",
+        "avx2" or "avx512"). An unknown or unsupported name is ignored. Only setActiveIsa() changes it.
+    */
+    KernelIsa getActiveIsa();
+
+    /** Picks the variant afresh, as getActiveIsa() did on its first call, from the environment variable
+        as it is now and what the CPU supports.
+    */
+    KernelIsa chooseIsa();
+
+    /** Switches every kernel to another supported variant, so tests can compare the variants in one
+        process. Returns false, changing nothing, when the variant isn't supported. Cascades only take
+        up its vector width when they are next prepared, so nothing should be processing meanwhile.
+    */
+    bool setActiveIsa(KernelIsa isa);
+
+    /** Whether the variant was built and the CPU can run it. */
+    bool isSupported(KernelIsa isa);
+
+    /** The width of the variant's vectors in bytes. */
+    int getVectorBytes(KernelIsa isa);
+
+    /** How many samples one vector of the active variant holds, which is what interleaved lanes are padded to. */
+    template<typename SampleType>
+    int getVectorSize() { return juce::jmax(1, getVectorBytes(getActiveIsa()) / (int)sizeof(SampleType)); }
+
+    const char* getIsaName(KernelIsa isa);
+
+    template<typename SampleType>
+    const FilterKernels<SampleType>& getFilterKernels(KernelIsa isa);
+
+    /** The filter kernels of the active variant. */
+    template<typename SampleType>
+    const FilterKernels<SampleType>& getFilterKernels();
+
+    /** The filter kernels of deterministic rendering: the generic loops with multiplies and adds never
+        fused, so they give the same bits on every CPU whichever variant is active elsewhere.
+    */
+    template<typename SampleType>
+    const FilterKernels<SampleType>& getDeterministicFilterKernels();
+
+    const SpectrumKernels& getSpectrumKernels(KernelIsa isa);
+
+    /** The spectrum kernels of the active variant. */
+    const SpectrumKernels& getSpectrumKernels();
+}
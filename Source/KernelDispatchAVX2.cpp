@@ -0,0 +1,28 @@
+/*
+  ==============================================================================
+
+    KernelDispatchAVX2.cpp
+
+  ==============================================================================
+*/
+
+#include "KernelVariants.h"
+
+//under MSVC its compiler flag scheme builds this file with /arch:AVX2
+#if SIMPLEEQ_KERNEL_ATTRIBUTES || (SIMPLEEQ_KERNEL_ARCH_FLAGS && defined(__AVX2__))
+namespace
+{
+    SIMPLEEQ_DEFINE_KERNEL_VARIANT(AVX2Kernels, SIMPLEEQ_KERNEL_TARGET("avx2,fma"))
+}
+
+bool KernelDispatch::getAVX2Kernels(VariantKernels& kernels)
+{
+    kernels = AVX2Kernels::getKernels();
+    return true;
+}
+#else
+bool KernelDispatch::getAVX2Kernels(VariantKernels&)
+{
+    return false;
+}
+#endif
@@ -0,0 +1,28 @@
+/*
+  ==============================================================================
+
+    KernelDispatchAVX512.cpp
+
+  ==============================================================================
+*/
+
+#include "KernelVariants.h"
+
+//under MSVC its compiler flag scheme builds this file with /arch:AVX512
+#if SIMPLEEQ_KERNEL_ATTRIBUTES || (SIMPLEEQ_KERNEL_ARCH_FLAGS && defined(__AVX512F__) && defined(__AVX512VL__))
+namespace
+{
+    SIMPLEEQ_DEFINE_KERNEL_VARIANT(AVX512Kernels, SIMPLEEQ_KERNEL_TARGET("avx512f,avx512vl,avx2,fma"))
+}
+
+bool KernelDispatch::getAVX512Kernels(VariantKernels& kernels)
+{
+    kernels = AVX512Kernels::getKernels();
+    return true;
+}
+#else
+bool KernelDispatch::getAVX512Kernels(VariantKernels&)
+{
+    return false;
+}
+#endif
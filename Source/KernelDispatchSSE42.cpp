@@ -0,0 +1,29 @@
+/*
+  ==============================================================================
+
+    KernelDispatchSSE42.cpp
+
+  ==============================================================================
+*/
+
+#include "KernelVariants.h"
+
+//under MSVC its compiler flag scheme builds this file with /arch:SSE4.2; a compiler too old for the flag
+//ignores it, and the variant is left out
+#if SIMPLEEQ_KERNEL_ATTRIBUTES || (SIMPLEEQ_KERNEL_ARCH_FLAGS && defined(__SSE4_2__))
+namespace
+{
+    SIMPLEEQ_DEFINE_KERNEL_VARIANT(SSE42Kernels, SIMPLEEQ_KERNEL_TARGET("sse4.2"))
+}
+
+bool KernelDispatch::getSSE42Kernels(VariantKernels& kernels)
+{
+    kernels = SSE42Kernels::getKernels();
+    return true;
+}
+#else
+bool KernelDispatch::getSSE42Kernels(VariantKernels&)
+{
+    return false;
+}
+#endif
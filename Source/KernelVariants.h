@@ -0,0 +1,167 @@
+/*
+  ==============================================================================
+
+    KernelVariants.h
+    The kernel bodies and the macro that builds a variant of them, shared by
+    KernelDispatch.cpp and the translation units of the instruction-set
+    variants. Only those files include it. Everything here has internal
+    linkage, so every file compiles its own copy for its own target and the
+    linker never swaps one variant's code into another.
+
+    GCC and Clang build a variant with per-function target attributes,
+    whatever the project targets. MSVC has no such attribute, so each variant
+    file is compiled whole for its instruction set, with the /arch flag its
+    compiler flag scheme in the .jucer sets, and only builds its variant when
+    that flag has reached it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "KernelDispatch.h"
+#include "BiquadCascade.h"
+#include <cmath>
+
+#if JUCE_INTEL && (defined(__GNUC__) || defined(__clang__))
+ #define SIMPLEEQ_KERNEL_ATTRIBUTES 1
+ #define SIMPLEEQ_KERNEL_ARCH_FLAGS 0
+ #define SIMPLEEQ_KERNEL_TARGET(isa) __attribute__((target(isa)))
+#elif JUCE_INTEL && defined(_MSC_VER) && !JUCE_DEBUG
+ //a debug build inlines nothing, not even __forceinline, so the bodies' shared helpers would be linked
+ //from whichever file's copy came first; debug builds keep to the generic variant
+ #define SIMPLEEQ_KERNEL_ATTRIBUTES 0
+ #define SIMPLEEQ_KERNEL_ARCH_FLAGS 1
+ #define SIMPLEEQ_KERNEL_TARGET(isa)
+#else
+ #define SIMPLEEQ_KERNEL_ATTRIBUTES 0
+ #define SIMPLEEQ_KERNEL_ARCH_FLAGS 0
+ #define SIMPLEEQ_KERNEL_TARGET(isa)
+#endif
+
+namespace KernelDispatch
+{
+    /** Every kernel of one variant. */
+    struct VariantKernels
+    {
+        FilterKernels<float> floatFilters;
+        FilterKernels<double> doubleFilters;
+        SpectrumKernels spectrum;
+    };
+
+    template<typename SampleType>
+    const FilterKernels<SampleType>& getFilters(const VariantKernels& kernels)
+    {
+        if constexpr (std::is_same_v<SampleType, float>)
+            return kernels.floatFilters;
+        else
+            return kernels.doubleFilters;
+    }
+
+    //each defined in the variant's own file; false, leaving the kernels alone, when the build has no such variant
+    bool getSSE42Kernels(VariantKernels& kernels);
+    bool getAVX2Kernels(VariantKernels& kernels);
+    bool getAVX512Kernels(VariantKernels& kernels);
+}
+
+namespace
+{
+    //the kernel bodies, inlined into every variant so each compiles them for its own instruction set
+    template<typename SampleType>
+    SIMPLEEQ_KERNEL_INLINE void runBiquadFrames(SampleType* frames, SampleType* s1, SampleType* s2, int lanes, int numFrames,
+                                                const BiquadCoefficients<SampleType>& c)
+    {
+        for (int i = 0; i < numFrames; ++i)
+            TDF2Biquad<SampleType>::processFrame(frames + i * lanes, s1, s2, lanes, c);
+    }
+
+    template<typename SampleType>
+    SIMPLEEQ_KERNEL_INLINE void runBiquadBlocks(SampleType* samples, SampleType& s1, SampleType& s2, int numBlocks,
+                                                const BiquadBlockKernel<SampleType>& kernel)
+    {
+        for (int block = 0; block < numBlocks; ++block)
+            TDF2Biquad<SampleType>::processBlock(samples + block * BiquadBlockKernel<SampleType>::length, s1, s2, kernel);
+    }
+
+    SIMPLEEQ_KERNEL_INLINE void runApplyWindow(float* samples, const float* window, int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            samples[i] *= window[i];
+    }
+
+    SIMPLEEQ_KERNEL_INLINE void runMagnitudesToDecibels(float* bins, int numBins, float scale, float negativeInfinity)
+    {
+        //juce::Decibels::gainToDecibels written out, so no shared template is compiled for a variant's target
+        for (int i = 0; i < numBins; ++i)
+        {
+            const auto gain = bins[i] * scale;
+            const auto decibels = gain > 0.f ? std::log10(gain) * 20.f : negativeInfinity;
+            bins[i] = decibels > negativeInfinity ? decibels : negativeInfinity;
+        }
+    }
+
+    SIMPLEEQ_KERNEL_INLINE void runFFTButterflies(float* real, float* imag, const float* twiddleReal, const float* twiddleImag, int size, int halfSpan)
+    {
+        for (int start = 0; start < size; start += 2 * halfSpan)
+        {
+            auto* real0 = real + start;
+            auto* imag0 = imag + start;
+            auto* real1 = real0 + halfSpan;
+            auto* imag1 = imag0 + halfSpan;
+
+            //the halves of a span don't overlap, so this is where the vectorising happens
+            for (int i = 0; i < halfSpan; ++i)
+            {
+                const auto twistedReal = real1[i] * twiddleReal[i] - imag1[i] * twiddleImag[i];
+                const auto twistedImag = real1[i] * twiddleImag[i] + imag1[i] * twiddleReal[i];
+
+                real1[i] = real0[i] - twistedReal;
+                imag1[i] = imag0[i] - twistedImag;
+                real0[i] += twistedReal;
+                imag0[i] += twistedImag;
+            }
+        }
+    }
+}
+
+//defines a namespace of the kernels built for Target, and its getKernels(); used inside an anonymous namespace
+#define SIMPLEEQ_DEFINE_KERNEL_VARIANT(Name, Target)                                                                        \
+    namespace Name                                                                                                          \
+    {                                                                                                                       \
+        template<typename SampleType>                                                                                       \
+        Target void biquadFrames(SampleType* frames, SampleType* s1, SampleType* s2, int lanes, int numFrames,              \
+                                 const BiquadCoefficients<SampleType>& c)                                                   \
+        {                                                                                                                   \
+            runBiquadFrames(frames, s1, s2, lanes, numFrames, c);                                                           \
+        }                                                                                                                   \
+                                                                                                                            \
+        template<typename SampleType>                                                                                       \
+        Target void biquadBlocks(SampleType* samples, SampleType& s1, SampleType& s2, int numBlocks,                        \
+                                 const BiquadBlockKernel<SampleType>& kernel)                                               \
+        {                                                                                                                   \
+            runBiquadBlocks(samples, s1, s2, numBlocks, kernel);                                                            \
+        }                                                                                                                   \
+                                                                                                                            \
+        Target void applyWindow(float* samples, const float* window, int numSamples)                                        \
+        {                                                                                                                   \
+            runApplyWindow(samples, window, numSamples);                                                                    \
+        }                                                                                                                   \
+                                                                                                                            \
+        Target void magnitudesToDecibels(float* bins, int numBins, float scale, float negativeInfinity)                     \
+        {                                                                                                                   \
+            runMagnitudesToDecibels(bins, numBins, scale, negativeInfinity);                                                \
+        }                                                                                                                   \
+                                                                                                                            \
+        Target void fftButterflies(float* real, float* imag, const float* twiddleReal, const float* twiddleImag,            \
+                                   int size, int halfSpan)                                                                  \
+        {                                                                                                                   \
+            runFFTButterflies(real, imag, twiddleReal, twiddleImag, size, halfSpan);                                        \
+        }                                                                                                                   \
+                                                                                                                            \
+        KernelDispatch::VariantKernels getKernels()                                                                         \
+        {                                                                                                                   \
+            return { { biquadFrames<float>, biquadBlocks<float> },                                                          \
+                     { biquadFrames<double>, biquadBlocks<double> },                                                        \
+                     { applyWindow, magnitudesToDecibels, fftButterflies } };                                               \
+        }                                                                                                                   \
+    }
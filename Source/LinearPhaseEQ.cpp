@@ -0,0 +1,252 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEQ.cpp
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseEQ.h"
+#include "SnapshotMorph.h"
+
+LinearPhaseEQ::LinearPhaseEQ() : juce::Thread("SimpleEQ Linear Phase Kernel")
+{
+}
+
+LinearPhaseEQ::~LinearPhaseEQ()
+{
+    stopThread(1000);
+}
+
+int LinearPhaseEQ::getKernelSizeForSampleRate(double sampleRate)
+{
+    return juce::nextPowerOfTwo((int)(sampleRate * 0.085));
+}
+
+void LinearPhaseEQ::prepare(const juce::dsp::ProcessSpec& spec, const ChainSettings& chainSettings)
+{
+    stopThread(1000);
+
+    preparedSpec = spec;
+    sampleRate = spec.sampleRate;
+    kernelSize = getKernelSizeForSampleRate(sampleRate);
+
+    {
+        const juce::SpinLock::ScopedLockType lock(settingsLock);
+        lastRequest = { chainSettings };
+        hasPendingSettings = false;
+    }
+
+    //playback is stopped, so the convolvers can go or be rebuilt for the new spec
+    convolutions.clear();
+    enabled.store(chainSettings.linearPhase, std::memory_order_release);
+
+    if (chainSettings.linearPhase)
+    {
+        createConvolutions({ chainSettings });
+        startThread();
+    }
+}
+
+void LinearPhaseEQ::setEnabled(bool shouldBeEnabled)
+{
+    if (shouldBeEnabled == isEnabled())
+        return;
+
+    if (!shouldBeEnabled)
+    {
+        //the audio thread may still be finishing a block through the convolvers, so they stay until the next prepare
+        enabled.store(false, std::memory_order_release);
+        stopThread(1000);
+        return;
+    }
+
+    KernelRequest request;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(settingsLock);
+        request = lastRequest;
+        hasPendingSettings = false;
+    }
+
+    //kept convolvers still hold the kernel from before the thread was stopped
+    if (convolutions.empty())
+        createConvolutions(request);
+    else
+        loadKernel(designKernel(request));
+
+    startThread();
+    enabled.store(true, std::memory_order_release);
+}
+
+void LinearPhaseEQ::createConvolutions(const KernelRequest& request)
+{
+    const auto numChannels = (int)preparedSpec.numChannels;
+    const auto numPairs = juce::jmax(1, (numChannels + 1) / 2);
+
+    for (int pair = 0; pair < numPairs; ++pair)
+        convolutions.push_back(std::make_unique<juce::dsp::Convolution>(juce::dsp::Convolution::Latency{ partitionSize }));
+
+    loadKernel(designKernel(request));
+
+    for (int pair = 0; pair < numPairs; ++pair)
+    {
+        auto pairSpec = preparedSpec;
+        pairSpec.numChannels = (juce::uint32)juce::jmin(2, numChannels - 2 * pair);
+        convolutions[(size_t)pair]->prepare(pairSpec);
+    }
+}
+
+void LinearPhaseEQ::reset()
+{
+    for (auto& convolution : convolutions)
+        convolution->reset();
+}
+
+void LinearPhaseEQ::setSettings(const KernelRequest& request)
+{
+    //if the designer thread is busy reading the pending request, try again on the next block
+    const juce::SpinLock::ScopedTryLockType lock(settingsLock);
+
+    if (!lock.isLocked() || request == lastRequest)
+        return;
+
+    lastRequest = request;
+    pendingRequest = request;
+    hasPendingSettings = true;
+    notify();
+}
+
+void LinearPhaseEQ::process(const juce::dsp::ProcessContextReplacing<float>& context)
+{
+    auto& block = context.getOutputBlock();
+    const auto numChannels = block.getNumChannels();
+
+    jassert(numChannels <= 2 * convolutions.size());
+
+    for (size_t first = 0, pair = 0; first < numChannels && pair < convolutions.size(); first += 2, ++pair)
+    {
+        auto pairBlock = block.getSubsetChannelBlock(first, juce::jmin((size_t)2, numChannels - first));
+        juce::dsp::ProcessContextReplacing<float> pairContext(pairBlock);
+        convolutions[pair]->process(pairContext);
+    }
+}
+
+int LinearPhaseEQ::getLatencyInSamples() const
+{
+    return kernelSize / 2 + (convolutions.empty() ? partitionSize : convolutions.front()->getLatency());
+}
+
+void LinearPhaseEQ::run()
+{
+    while (!threadShouldExit())
+    {
+        wait(-1);
+
+        KernelRequest request;
+        bool shouldRebuild;
+
+        {
+            const juce::SpinLock::ScopedLockType lock(settingsLock);
+            request = pendingRequest;
+            shouldRebuild = hasPendingSettings;
+            hasPendingSettings = false;
+        }
+
+        if (shouldRebuild && !threadShouldExit())
+            loadKernel(designKernel(request));
+    }
+}
+
+void LinearPhaseEQ::loadKernel(const juce::AudioBuffer<float>& kernel)
+{
+    //every convolver takes ownership of its own copy
+    for (auto& convolution : convolutions)
+    {
+        convolution->loadImpulseResponse(juce::AudioBuffer<float>(kernel),
+                                         sampleRate,
+                                         juce::dsp::Convolution::Stereo::no,
+                                         juce::dsp::Convolution::Trim::no,
+                                         juce::dsp::Convolution::Normalise::no);
+    }
+}
+
+juce::AudioBuffer<float> LinearPhaseEQ::designKernel(const KernelRequest& request) const
+{
+    const auto& chainSettings = request.settings;
+
+    const auto fftOrder = juce::roundToInt(std::log2((double)kernelSize));
+    const auto numBins = kernelSize / 2 + 1;
+
+    //interleaved real/imaginary pairs, as expected by performRealOnlyInverseTransform
+    std::vector<float> spectrum((size_t)kernelSize * 2, 0.f);
+
+    //a bypassed EQ keeps running as a pure delay so the latency doesn't jump
+    if (chainSettings.globalBypassed)
+    {
+        for (int bin = 0; bin < numBins; ++bin)
+            spectrum[(size_t)bin * 2] = 1.f;
+    }
+    else if (request.morphed)
+    {
+        EQSectionList<double> sections;
+        SnapshotMorph::designBlendedSections(sections, request.morphFrom, request.morphTo, request.morphAmount, sampleRate);
+
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            const auto freq = juce::jmax(1.0, bin * sampleRate / kernelSize);
+            auto mag = 1.0;
+
+            for (int slot = 0; slot < MaxSections; ++slot)
+            {
+                if (sections.active[slot])
+                    mag *= sections.coefficients[slot].getMagnitudeForFrequency(freq, sampleRate);
+            }
+
+            spectrum[(size_t)bin * 2] = (float)mag;
+        }
+    }
+    else
+    {
+        MonoChainType<double> chain;
+        updateMonoChain(chain, chainSettings, sampleRate);
+
+        std::vector<BiquadCoefficients<double>> bands;
+        for (const auto& band : chainSettings.bands)
+        {
+            if (isBandActive(band))
+                bands.push_back(makeBandCoefficients<double>(band, sampleRate, chainSettings.matchedResponse));
+        }
+
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            //the response at DC is taken just above it, where the cut filters are still defined
+            const auto freq = juce::jmax(1.0, bin * sampleRate / kernelSize);
+            auto mag = getMagnitudeForFrequency(chain, freq, sampleRate);
+
+            for (const auto& band : bands)
+                mag *= band.getMagnitudeForFrequency(freq, sampleRate);
+
+            //zero phase: the kernel comes out symmetric around sample 0
+            spectrum[(size_t)bin * 2] = (float)mag;
+        }
+    }
+
+    juce::dsp::FFT fft(fftOrder);
+    fft.performRealOnlyInverseTransform(spectrum.data());
+
+    //rotate the centre of the kernel to kernelSize / 2 to make it causal, then apply a
+    //periodic Blackman window, which is exactly symmetric around that same centre
+    juce::AudioBuffer<float> kernel(1, kernelSize);
+    auto* out = kernel.getWritePointer(0);
+
+    for (int i = 0; i < kernelSize; ++i)
+    {
+        const auto phase = juce::MathConstants<double>::twoPi * i / kernelSize;
+        const auto window = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+
+        out[i] = spectrum[(size_t)((i + kernelSize / 2) % kernelSize)] * (float)window;
+    }
+
+    return kernel;
+}
@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEQ.h
+    Linear-phase alternative to the IIR chain. The magnitude response of the
+    current settings is turned into a symmetric FIR kernel on a background
+    thread, and the kernel is run through juce::dsp::Convolution, which uses
+    uniformly partitioned FFT convolution and crossfades between kernels when
+    a new one arrives. Convolution handles at most two channels, so wider
+    buses get one convolver per channel pair, all running the same kernel.
+    The convolvers and the designer thread only exist while linear phase is
+    enabled, so an instance that never uses it pays nothing for it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+
+class LinearPhaseEQ : private juce::Thread
+{
+public:
+    //partition size of the convolution; adds this many samples of latency on top of the kernel's own
+    static constexpr int partitionSize = 256;
+
+    LinearPhaseEQ();
+    ~LinearPhaseEQ() override;
+
+    /** Takes the playback spec and enables linear phase if the settings ask for it. When they do, builds
+        the convolvers and designs the first kernel synchronously so the output is valid from the first
+        block; otherwise releases them.
+    */
+    void prepare(const juce::dsp::ProcessSpec& spec, const ChainSettings& chainSettings);
+    void reset();
+
+    /** Creates the convolvers, designs a kernel for the latest settings and starts the designer thread,
+        or stops the thread when disabled. Not for the audio thread; until this has enabled it, the
+        audio thread mustn't call process().
+    */
+    void setEnabled(bool shouldBeEnabled);
+    bool isEnabled() const { return enabled.load(std::memory_order_acquire); }
+
+    /** What a kernel is designed from. While the morph is on it also holds the two snapshots the IIR path
+        is blending and how far along it is, so the kernel is drawn from the same blended sections.
+    */
+    struct KernelRequest
+    {
+        ChainSettings settings;
+
+        bool morphed = false;
+        ChainSettings morphFrom, morphTo;
+        float morphAmount = 0.f;
+
+        bool operator==(const KernelRequest& other) const
+        {
+            return settings == other.settings && morphed == other.morphed
+                && (!morphed || (morphFrom == other.morphFrom && morphTo == other.morphTo && morphAmount == other.morphAmount));
+        }
+    };
+
+    /** Queues a kernel rebuild when the request has changed. Safe to call from the audio thread. */
+    void setSettings(const KernelRequest& request);
+
+    void process(const juce::dsp::ProcessContextReplacing<float>& context);
+
+    /** The kernel's centre delay plus the latency of the partitioned convolution. */
+    int getLatencyInSamples() const;
+    int getKernelSize() const { return kernelSize; }
+
+    /** Picks a power-of-two kernel length of roughly 85ms, enough to resolve the lowest cut frequencies. */
+    static int getKernelSizeForSampleRate(double sampleRate);
+
+private:
+    void run() override;
+
+    juce::AudioBuffer<float> designKernel(const KernelRequest& request) const;
+    void loadKernel(const juce::AudioBuffer<float>& kernel);
+    void createConvolutions(const KernelRequest& request);
+
+    std::vector<std::unique_ptr<juce::dsp::Convolution>> convolutions;
+    std::atomic<bool> enabled{ false };
+
+    juce::dsp::ProcessSpec preparedSpec{ 44100.0, 0, 0 };
+    double sampleRate = 44100.0;
+    int kernelSize = 0;
+
+    juce::SpinLock settingsLock;
+    KernelRequest pendingRequest, lastRequest;
+    bool hasPendingSettings = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LinearPhaseEQ)
+};
@@ -0,0 +1,169 @@
+/*
+  ==============================================================================
+
+    MatchedDesign.cpp
+
+  ==============================================================================
+*/
+
+#include "MatchedDesign.h"
+
+namespace MatchedDesign
+{
+    namespace
+    {
+        //analog second-order sections in s normalised to radians per sample: (b0 s^2 + b1 s + b2) / (a0 s^2 + a1 s + a2)
+        struct AnalogSection
+        {
+            double b0, b1, b2, a0, a1, a2;
+
+            double getMagnitudeSquared(double omega) const
+            {
+                const std::complex<double> s(0.0, omega);
+                return std::norm((b0 * s * s + b1 * s + b2) / (a0 * s * s + a1 * s + a2));
+            }
+        };
+
+        //the analog poles of s^2 + (omega / q) s + omega^2 mapped through z = e^s
+        void matchPoles(double omega, double q, BiquadCoefficients<double>& c)
+        {
+            const auto zeta = 0.5 / q;
+            const auto decay = std::exp(-zeta * omega);
+
+            if (zeta <= 1.0)
+                c.a1 = -2.0 * decay * std::cos(omega * std::sqrt(1.0 - zeta * zeta));
+            else
+                c.a1 = -2.0 * decay * std::cosh(omega * std::sqrt(zeta * zeta - 1.0));
+
+            c.a2 = decay * decay;
+        }
+
+        //the squared magnitude of a biquad is (B0 phi0 + B1 phi1 + B2 phi2) / (A0 phi0 + A1 phi1 + A2 phi2) with
+        //phi1 = sin^2(omega / 2), phi0 = 1 - phi1 and phi2 = 4 phi0 phi1; this turns B0..B2 back into a minimum-phase numerator
+        void factoriseNumerator(double B0, double B1, double B2, BiquadCoefficients<double>& c)
+        {
+            const auto root0 = std::sqrt(juce::jmax(0.0, B0));
+            const auto root1 = std::sqrt(juce::jmax(0.0, B1));
+            const auto W = 0.5 * (root0 + root1);
+
+            c.b0 = 0.5 * (W + std::sqrt(juce::jmax(0.0, W * W + B2)));
+            c.b1 = 0.5 * (root0 - root1);
+            c.b2 = c.b0 > 0.0 ? -B2 / (4.0 * c.b0) : 0.0;
+        }
+
+        void getDenominatorTerms(const BiquadCoefficients<double>& c, double& A0, double& A1, double& A2)
+        {
+            A0 = (1.0 + c.a1 + c.a2) * (1.0 + c.a1 + c.a2);
+            A1 = (1.0 - c.a1 + c.a2) * (1.0 - c.a1 + c.a2);
+            A2 = -4.0 * c.a2;
+        }
+
+        BiquadCoefficients<double> invert(const BiquadCoefficients<double>& c)
+        {
+            return { 1.0 / c.b0, c.a1 / c.b0, c.a2 / c.b0, c.b1 / c.b0, c.b2 / c.b0 };
+        }
+
+        double getNormalisedFrequency(double sampleRate, double frequency)
+        {
+            //keep the design below nyquist when the host runs at a low sample rate
+            return juce::MathConstants<double>::twoPi * juce::jmin(frequency, sampleRate * 0.49) / sampleRate;
+        }
+
+        //a boost, gainFactor >= 1
+        BiquadCoefficients<double> makePeakBoost(double omega, double q, double gainFactor)
+        {
+            const auto A = std::sqrt(gainFactor);
+
+            BiquadCoefficients<double> c;
+            matchPoles(omega, q * A, c);
+
+            double A0, A1, A2;
+            getDenominatorTerms(c, A0, A1, A2);
+
+            const auto phi1 = std::pow(std::sin(0.5 * omega), 2.0);
+            const auto phi0 = 1.0 - phi1;
+            const auto phi2 = 4.0 * phi0 * phi1;
+
+            //unity at DC, the full gain at the centre, and a flat top there
+            const auto R1 = (A0 * phi0 + A1 * phi1 + A2 * phi2) * gainFactor * gainFactor;
+            const auto R2 = (A1 - A0 + 4.0 * (phi0 - phi1) * A2) * gainFactor * gainFactor;
+
+            const auto B0 = A0;
+            const auto B2 = (R1 - R2 * phi1 - B0) / (4.0 * phi1 * phi1);
+            const auto B1 = R2 + B0 + 4.0 * (phi1 - phi0) * B2;
+
+            factoriseNumerator(B0, B1, B2, c);
+            return c;
+        }
+
+        //a shelf whose poles sit at omegaPole, at or below the corner
+        BiquadCoefficients<double> makeShelf(const AnalogSection& analog, double omega, double omegaPole, double q)
+        {
+            BiquadCoefficients<double> c;
+            matchPoles(omegaPole, q, c);
+
+            double A0, A1, A2;
+            getDenominatorTerms(c, A0, A1, A2);
+
+            const auto phi1 = std::pow(std::sin(0.5 * omega), 2.0);
+            const auto phi0 = 1.0 - phi1;
+            const auto phi2 = 4.0 * phi0 * phi1;
+
+            const auto B0 = analog.getMagnitudeSquared(0.0) * A0;
+            const auto B1 = analog.getMagnitudeSquared(juce::MathConstants<double>::pi) * A1;
+            const auto B2 = (analog.getMagnitudeSquared(omega) * (A0 * phi0 + A1 * phi1 + A2 * phi2) - B0 * phi0 - B1 * phi1) / phi2;
+
+            factoriseNumerator(B0, B1, B2, c);
+            return c;
+        }
+
+        //the RBJ low shelf boosting by gainFactor >= 1, with poles at omega / sqrt(A)
+        BiquadCoefficients<double> makeLowShelfBoost(double omega, double q, double gainFactor)
+        {
+            const auto A = std::sqrt(gainFactor);
+            const auto rootA = std::sqrt(A);
+
+            const AnalogSection analog{ A, A * rootA * omega / q, A * A * omega * omega,
+                                        A, rootA * omega / q, omega * omega };
+
+            return makeShelf(analog, omega, omega / rootA, q);
+        }
+
+        //the RBJ high shelf cutting by gainFactor <= 1, with poles at omega * sqrt(A)
+        BiquadCoefficients<double> makeHighShelfCut(double omega, double q, double gainFactor)
+        {
+            const auto A = std::sqrt(gainFactor);
+            const auto rootA = std::sqrt(A);
+
+            const AnalogSection analog{ A * A, A * rootA * omega / q, A * omega * omega,
+                                        1.0, rootA * omega / q, A * omega * omega };
+
+            return makeShelf(analog, omega, omega * rootA, q);
+        }
+    }
+
+    BiquadCoefficients<double> makePeakFilter(double sampleRate, double frequency, double q, double gainFactor)
+    {
+        const auto omega = getNormalisedFrequency(sampleRate, frequency);
+
+        //a cut is the boost by the reciprocal gain turned upside down
+        return gainFactor >= 1.0 ? makePeakBoost(omega, q, gainFactor)
+                                 : invert(makePeakBoost(omega, q, 1.0 / gainFactor));
+    }
+
+    BiquadCoefficients<double> makeLowShelf(double sampleRate, double frequency, double q, double gainFactor)
+    {
+        const auto omega = getNormalisedFrequency(sampleRate, frequency);
+
+        return gainFactor >= 1.0 ? makeLowShelfBoost(omega, q, gainFactor)
+                                 : invert(makeLowShelfBoost(omega, q, 1.0 / gainFactor));
+    }
+
+    BiquadCoefficients<double> makeHighShelf(double sampleRate, double frequency, double q, double gainFactor)
+    {
+        const auto omega = getNormalisedFrequency(sampleRate, frequency);
+
+        return gainFactor <= 1.0 ? makeHighShelfCut(omega, q, gainFactor)
+                                 : invert(makeHighShelfCut(omega, q, 1.0 / gainFactor));
+    }
+}
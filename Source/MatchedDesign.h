@@ -0,0 +1,41 @@
+/*
+  ==============================================================================
+
+    MatchedDesign.h
+    Closed-form matched-response peak and shelf designs, after Vicanek's
+    "Matched Second Order Digital Filters". The poles are the analog poles
+    mapped exactly through z = e^sT, and the zeros are solved for so the
+    magnitude agrees with the analog prototype at chosen frequencies. Unlike
+    the bilinear designs, bands near nyquist keep their analog width and
+    shape instead of being squeezed towards it. A cut is designed as the exact
+    inverse of the matching boost, which keeps the poles on the low side of
+    the band where the mapping is most accurate.
+
+    The result is an ordinary normalised biquad, so it runs through the same
+    sections at the same cost per sample; only the design takes a few more
+    transcendental calls.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadCascade.h"
+
+namespace MatchedDesign
+{
+    /** The RBJ analog peak, matched at DC and in both value and slope at its centre. */
+    BiquadCoefficients<double> makePeakFilter(double sampleRate, double frequency, double q, double gainFactor);
+
+    /** The RBJ analog shelves, matched at DC, at nyquist and at the corner frequency. */
+    BiquadCoefficients<double> makeLowShelf(double sampleRate, double frequency, double q, double gainFactor);
+    BiquadCoefficients<double> makeHighShelf(double sampleRate, double frequency, double q, double gainFactor);
+
+    template<typename SampleType>
+    BiquadCoefficients<SampleType> toPrecision(const BiquadCoefficients<double>& c)
+    {
+        return { static_cast<SampleType>(c.b0), static_cast<SampleType>(c.b1), static_cast<SampleType>(c.b2),
+                 static_cast<SampleType>(c.a1), static_cast<SampleType>(c.a2) };
+    }
+}
@@ -0,0 +1,162 @@
+/*
+  ==============================================================================
+
+    OversamplingStage.h
+    Optional 2x/4x oversampling around the engine's cascades, built on JUCE's
+    polyphase half-band filters in either their IIR (low latency) or
+    equiripple FIR (linear phase) form. All four variants are built in
+    prepare(), so changing the mode never allocates.
+
+    While a mode is selected the whole bus runs through a compensating delay
+    of the oversampler's latency, whether or not the oversampler is currently
+    engaged. That keeps the reported latency constant as the engine switches
+    the oversampling on and off, and keeps the dry signal of a crossfade
+    lined up with the wet one.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <memory>
+#include <vector>
+#include "ChainSettings.h"
+
+template<typename SampleType>
+class OversamplingStage
+{
+public:
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        using Oversampling = juce::dsp::Oversampling<SampleType>;
+
+        maxBlockSize = (int)spec.maximumBlockSize;
+        int maxLatency = 0;
+
+        for (int filterIndex = 0; filterIndex < 2; ++filterIndex)
+        {
+            const auto filterType = filterIndex == OversamplingFilter_FIR ? Oversampling::filterHalfBandFIREquiripple
+                                                                     : Oversampling::filterHalfBandPolyphaseIIR;
+
+            for (int stages = 1; stages <= 2; ++stages)
+            {
+                //integer latency, so what the host is told is exactly what it gets
+                auto& oversampler = oversamplers[(size_t)filterIndex][(size_t)stages - 1];
+                oversampler = std::make_unique<Oversampling>((size_t)spec.numChannels, (size_t)stages, filterType, true, true);
+                oversampler->initProcessing((size_t)spec.maximumBlockSize);
+
+                maxLatency = juce::jmax(maxLatency, juce::roundToInt(oversampler->getLatencyInSamples()));
+            }
+        }
+
+        input.setSize((int)spec.numChannels, (int)spec.maximumBlockSize, false, true, false);
+        channelPointers.assign((size_t)spec.numChannels, nullptr);
+
+        compensation.setMaximumDelayInSamples(maxLatency + 1);
+        compensation.prepare(spec);
+
+        active = nullptr;
+        setMode(factor, filter);
+        reset();
+    }
+
+    /** Picks the oversampler for the mode. Returns true when that changes the latency. */
+    bool setMode(OversamplingFactor newFactor, OversamplingFilter newFilter)
+    {
+        const auto previousLatency = getLatencyInSamples();
+        auto* previous = active;
+
+        factor = newFactor;
+        filter = newFilter;
+        active = factor == Oversampling_Off ? nullptr : oversamplers[(size_t)filter][(size_t)factor - 1].get();
+
+        if (active != previous)
+        {
+            reset();
+            compensation.setDelay(static_cast<SampleType>(getLatencyInSamples()));
+        }
+
+        return getLatencyInSamples() != previousLatency;
+    }
+
+    bool isSelected() const { return active != nullptr; }
+
+    int getFactor() const { return active != nullptr ? (int)active->getOversamplingFactor() : 1; }
+
+    int getLatencyInSamples() const { return active != nullptr ? juce::roundToInt(active->getLatencyInSamples()) : 0; }
+
+    int getMaximumBlockSize() const { return maxBlockSize; }
+
+    void reset()
+    {
+        resetOversampler();
+        compensation.reset();
+    }
+
+    /** Clears the half-band filters but leaves the compensating delay running. */
+    void resetOversampler()
+    {
+        if (active != nullptr)
+            active->reset();
+    }
+
+    /** Delays every channel by the latency. With keepInput, the undelayed block is kept
+        for upsample(); the block must then fit in the prepared size.
+    */
+    void delay(juce::AudioBuffer<SampleType>& buffer, bool keepInput)
+    {
+        const auto numSamples = buffer.getNumSamples();
+        jassert(!keepInput || numSamples <= input.getNumSamples());
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            if (keepInput)
+                input.copyFrom(channel, 0, buffer, channel, 0, numSamples);
+
+            auto* samples = buffer.getWritePointer(channel);
+            for (int i = 0; i < numSamples; ++i)
+            {
+                compensation.pushSample(channel, samples[i]);
+                samples[i] = compensation.popSample(channel);
+            }
+        }
+    }
+
+    /** The undelayed copy kept by the last delay(), for processing before it is upsampled. */
+    juce::AudioBuffer<SampleType>& getInput() { return input; }
+
+    /** Upsamples channels of the undelayed copy and returns a buffer over the oversampled samples. */
+    juce::AudioBuffer<SampleType> upsample(int startChannel, int numChannels, int numSamples)
+    {
+        auto block = juce::dsp::AudioBlock<SampleType>(input).getSubsetChannelBlock((size_t)startChannel, (size_t)numChannels)
+                                                             .getSubBlock(0, (size_t)numSamples);
+        auto oversampled = active->processSamplesUp(block);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            channelPointers[(size_t)channel] = oversampled.getChannelPointer((size_t)channel);
+
+        return { channelPointers.data(), numChannels, (int)oversampled.getNumSamples() };
+    }
+
+    /** Brings the oversampled channels back down into the same channels of the buffer. */
+    void downsample(juce::AudioBuffer<SampleType>& buffer, int startChannel, int numChannels)
+    {
+        auto block = juce::dsp::AudioBlock<SampleType>(buffer).getSubsetChannelBlock((size_t)startChannel, (size_t)numChannels);
+        active->processSamplesDown(block);
+    }
+
+private:
+    //[filter][factor - 1]
+    std::array<std::array<std::unique_ptr<juce::dsp::Oversampling<SampleType>>, 2>, 2> oversamplers;
+    juce::dsp::Oversampling<SampleType>* active = nullptr;
+
+    OversamplingFactor factor = Oversampling_Off;
+    OversamplingFilter filter = OversamplingFilter_IIR;
+
+    juce::AudioBuffer<SampleType> input;
+    juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::None> compensation;
+    std::vector<SampleType*> channelPointers;
+    int maxBlockSize = 0;
+};
@@ -0,0 +1,522 @@
+/*
+  ==============================================================================
+
+    ParallelCascade.h
+    The active sections of a biquad cascade rewritten in parallel form by
+    partial-fraction expansion: a direct gain plus one branch per section,
+    each branch keeping that section's poles over a first-order numerator.
+    The branches don't depend on one another, so a channel's branches are
+    computed side by side in SIMD lanes and then summed, where the serial
+    cascade has to finish each section before the next one can start.
+
+    An expansion is only as good as its conditioning. Poles that sit close
+    together, as those of a steep cut at a low frequency do, give residues
+    far larger than the response they sum to, and the cancellation costs
+    precision. Every expansion is therefore checked against the cascade it
+    came from, and the serial cascade takes over, with a crossfade, whenever
+    it doesn't hold up.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <complex>
+#include "BiquadCascade.h"
+
+namespace ParallelForm
+{
+    /** The direct gain and the branches of an expansion. A branch sits in the slot of the section
+        whose poles it has, so a ramp between two expansions moves each branch between like poles.
+    */
+    template<int NumSlots>
+    struct Expansion
+    {
+        double directGain = 0.0;
+        std::array<BiquadCoefficients<double>, NumSlots> branches;
+        std::array<bool, NumSlots> active{};
+    };
+
+    //how far the branches may outgrow the response they sum to; a float engine keeps at least 14 of its 24 bits
+    template<typename SampleType>
+    constexpr double getMaxGainSpread() { return std::is_same_v<SampleType, float> ? 1.0e3 : 1.0e8; }
+
+    //the largest error the expansion may show against the cascade, relative to the cascade's peak
+    static constexpr double maxResponseError = 1.0e-4;
+
+    //poles closer to the origin or to one another than this are treated as coincident
+    static constexpr double poleTolerance = 1.0e-12;
+
+    static constexpr int numCheckFrequencies = 32;
+
+    /** Expands the active sections, or returns false when the expansion can't be trusted:
+        coincident poles, a pole at the origin, or branches so much larger than the response
+        that summing them would lose too much precision. Allocation-free.
+    */
+    template<typename SampleType, int NumSlots>
+    bool expand(const SectionList<BiquadCoefficients<SampleType>, NumSlots>& sections, Expansion<NumSlots>& expansion,
+                double sampleRate, double maxGainSpread)
+    {
+        using Complex = std::complex<double>;
+
+        //the two poles of every active section, paired in neighbouring entries
+        std::array<Complex, 2 * NumSlots> poles;
+        std::array<int, NumSlots> slots{};
+        int numSections = 0;
+
+        for (int slot = 0; slot < NumSlots; ++slot)
+        {
+            expansion.active[slot] = sections.active[slot];
+
+            if (!sections.active[slot])
+                continue;
+
+            const auto& c = sections.coefficients[slot];
+            const auto root = std::sqrt(Complex(double(c.a1) * double(c.a1) - 4.0 * double(c.a2)));
+
+            poles[(size_t)(2 * numSections)] = (-double(c.a1) + root) * 0.5;
+            poles[(size_t)(2 * numSections + 1)] = (-double(c.a1) - root) * 0.5;
+            slots[(size_t)numSections++] = slot;
+        }
+
+        const auto numPoles = 2 * numSections;
+
+        for (int k = 0; k < numPoles; ++k)
+        {
+            if (std::abs(poles[(size_t)k]) < poleTolerance || std::abs(poles[(size_t)k]) >= 1.0)
+                return false;
+
+            for (int j = k + 1; j < numPoles; ++j)
+            {
+                if (std::abs(poles[(size_t)k] - poles[(size_t)j]) < poleTolerance)
+                    return false;
+            }
+        }
+
+        //H(w) = prod B(w) / prod (1 - p w) with w = 1/z, so the residue at p is the numerator over the
+        //other poles' factors at w = 1/p, and the direct gain is what's left of H(0) = prod b0
+        std::array<Complex, 2 * NumSlots> residues;
+        Complex sumOfResidues;
+        double gainAtOrigin = 1.0;
+
+        for (int section = 0; section < numSections; ++section)
+            gainAtOrigin *= double(sections.coefficients[slots[(size_t)section]].b0);
+
+        for (int k = 0; k < numPoles; ++k)
+        {
+            const auto w = 1.0 / poles[(size_t)k];
+            Complex residue = 1.0;
+
+            for (int section = 0; section < numSections; ++section)
+            {
+                const auto& c = sections.coefficients[slots[(size_t)section]];
+                residue *= double(c.b0) + w * (double(c.b1) + w * double(c.b2));
+            }
+
+            for (int j = 0; j < numPoles; ++j)
+            {
+                if (j != k)
+                    residue /= 1.0 - poles[(size_t)j] * w;
+            }
+
+            residues[(size_t)k] = residue;
+            sumOfResidues += residue;
+        }
+
+        expansion.directGain = gainAtOrigin - sumOfResidues.real();
+
+        //bounds the largest output any one term can reach for a full-scale input
+        auto gainSpread = std::abs(expansion.directGain);
+
+        for (int section = 0; section < numSections; ++section)
+        {
+            const auto p = poles[(size_t)(2 * section)], q = poles[(size_t)(2 * section + 1)];
+            const auto rp = residues[(size_t)(2 * section)], rq = residues[(size_t)(2 * section + 1)];
+            const auto& c = sections.coefficients[slots[(size_t)section]];
+
+            //rp / (1 - p w) + rq / (1 - q w) over the section's own denominator; for a conjugate pair the sums are real
+            auto& branch = expansion.branches[(size_t)slots[(size_t)section]];
+            branch = { (rp + rq).real(), -(rp * q + rq * p).real(), 0.0, double(c.a1), double(c.a2) };
+
+            gainSpread += std::abs(rp) / (1.0 - std::abs(p)) + std::abs(rq) / (1.0 - std::abs(q));
+        }
+
+        //the cascade's response against the expansion's, on a log grid up to just below nyquist
+        double peak = 1.0e-6, error = 0.0;
+
+        for (int index = 0; index < numCheckFrequencies; ++index)
+        {
+            const auto frequency = 20.0 * std::pow(0.49 * sampleRate / 20.0, index / double(numCheckFrequencies - 1));
+            const auto w = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate);
+
+            Complex cascade = 1.0, parallel = expansion.directGain;
+
+            for (int section = 0; section < numSections; ++section)
+            {
+                const auto& c = sections.coefficients[slots[(size_t)section]];
+                const auto& branch = expansion.branches[(size_t)slots[(size_t)section]];
+                const auto denominator = 1.0 + w * (double(c.a1) + w * double(c.a2));
+
+                cascade *= (double(c.b0) + w * (double(c.b1) + w * double(c.b2))) / denominator;
+                parallel += (branch.b0 + w * branch.b1) / denominator;
+            }
+
+            peak = juce::jmax(peak, std::abs(cascade));
+            error = juce::jmax(error, std::abs(cascade - parallel));
+        }
+
+        return gainSpread <= maxGainSpread * juce::jmax(1.0, peak) && error <= maxResponseError * juce::jmax(1.0, peak);
+    }
+}
+
+//==============================================================================
+/** Runs a cascade's sections in parallel form while their expansion holds up, and
+    as the plain serial cascade otherwise. The state of a channel's branches is kept
+    contiguous, [lane][branch], so the branches are what fills the SIMD registers.
+*/
+template<typename SampleType, int NumSlots>
+struct ParallelCascade
+{
+    using Sections = SectionList<BiquadCoefficients<SampleType>, NumSlots>;
+    using Expansion = ParallelForm::Expansion<NumSlots>;
+
+    //length of the crossfade when the cascade moves between the two forms
+    static constexpr double formCrossfadeLengthInSeconds = 0.005;
+
+    void prepare(int maxChannels, int maxBlockSize)
+    {
+        serial.prepare(maxChannels, maxBlockSize);
+
+        numLanes = juce::jmax(1, maxChannels);
+        state1.assign((size_t)(numLanes * maxBranches), SampleType(0));
+        state2.assign((size_t)(numLanes * maxBranches), SampleType(0));
+        fadeBuffer.setSize(numLanes, juce::jmax(1, maxBlockSize), false, true, false);
+
+        fadeSamplesRemaining = 0;
+    }
+
+    void reset()
+    {
+        serial.reset();
+        std::fill(state1.begin(), state1.end(), SampleType(0));
+        std::fill(state2.begin(), state2.end(), SampleType(0));
+
+        fadeSamplesRemaining = 0;
+    }
+
+    /** Sets the sections, with their expansion when it could be trusted and nullptr when it couldn't.
+        Ramps behave as they do in SectionCascade, both for the serial sections and for the branches.
+    */
+    void setSections(const Sections& sections, const Expansion* expansion, double sampleRate, int rampLengthInSamples = 0)
+    {
+        const bool shouldUseParallel = expansion != nullptr;
+        const bool switchesForm = shouldUseParallel != useParallel;
+
+        //the form taking over has been idle, so it starts clean and on its new design
+        serial.setSections(sections, switchesForm && !shouldUseParallel ? 0 : rampLengthInSamples);
+
+        if (switchesForm)
+        {
+            if (shouldUseParallel)
+            {
+                std::fill(state1.begin(), state1.end(), SampleType(0));
+                std::fill(state2.begin(), state2.end(), SampleType(0));
+                wasActive.fill(false);
+            }
+            else
+            {
+                serial.reset();
+            }
+
+            fadeLength = fadeSamplesRemaining = juce::jmax(1, juce::roundToInt(formCrossfadeLengthInSeconds * sampleRate));
+            useParallel = shouldUseParallel;
+        }
+
+        if (shouldUseParallel)
+            setBranches(*expansion, switchesForm ? 0 : rampLengthInSamples);
+    }
+
+    bool isUsingParallelForm() const { return useParallel; }
+
+    /** The branches are compiled with the rest of the engine and don't depend on the block size, so only the serial form needs telling. */
+    void setDeterministic(bool shouldBeDeterministic) { serial.setDeterministic(shouldBeDeterministic); }
+
+    int getNumActiveSlots() const { return serial.getNumActiveSlots(); }
+
+    /** The two forms share their poles, so the serial sections stand in for both when estimating decay. */
+    const BiquadCoefficients<SampleType>& getActiveCoefficients(int index) const { return serial.getActiveCoefficients(index); }
+
+    /** Filters channels [startChannel, startChannel + numChannels) in place. */
+    void process(juce::AudioBuffer<SampleType>& buffer, int startChannel, int numChannels)
+    {
+        numChannels = juce::jmin(numChannels, numLanes, buffer.getNumChannels() - startChannel);
+
+        if (numChannels <= 0)
+            return;
+
+        if (fadeSamplesRemaining > 0)
+        {
+            //the fade buffer only holds a prepared block, so anything larger is faded in pieces
+            for (int offset = 0; offset < buffer.getNumSamples(); offset += fadeBuffer.getNumSamples())
+            {
+                juce::AudioBuffer<SampleType> subBlock(buffer.getArrayOfWritePointers() + startChannel, numChannels, offset,
+                                                       juce::jmin(fadeBuffer.getNumSamples(), buffer.getNumSamples() - offset));
+
+                if (fadeSamplesRemaining > 0)
+                    processFading(subBlock, numChannels);
+                else
+                    processForm(useParallel, subBlock, 0, numChannels);
+            }
+        }
+        else
+        {
+            processForm(useParallel, buffer, startChannel, numChannels);
+        }
+    }
+
+    /** True while the two forms are being crossfaded, which processMidSide() doesn't do. */
+    bool isCrossfadingForms() const { return fadeSamplesRemaining > 0; }
+
+    /** Filters the mid or the side of channels 0 and 1, converting to mid/side and back as each sample is
+        read and written, like SectionCascade::processMidSide(). Not for use while crossfading forms.
+    */
+    void processMidSide(juce::AudioBuffer<SampleType>& buffer, bool filterSide)
+    {
+        jassert(!isCrossfadingForms());
+
+        if (numLanes == 0 || buffer.getNumChannels() < 2)
+            return;
+
+        if (!useParallel)
+        {
+            serial.processMidSide(buffer, filterSide);
+            return;
+        }
+
+        auto* left = buffer.getWritePointer(0);
+        auto* right = buffer.getWritePointer(1);
+        const auto sign = filterSide ? SampleType(-1) : SampleType(1);
+        const auto numSamples = buffer.getNumSamples();
+        const auto rampSamples = juce::jmin(numSamples, rampSamplesRemaining);
+
+        current = processLane(0, numSamples, rampSamples,
+            [=](int i) { return SampleType(0.5) * (left[i] + sign * right[i]); },
+            [=](int i, SampleType filtered)
+            {
+                //the half that wasn't filtered still comes from the untouched pair
+                const auto other = SampleType(0.5) * (left[i] - sign * right[i]);
+                const auto mid = filterSide ? other : filtered;
+                const auto side = filterSide ? filtered : other;
+
+                left[i] = mid + side;
+                right[i] = mid - side;
+            });
+
+        rampSamplesRemaining -= rampSamples;
+    }
+
+private:
+    static constexpr int vectorSize = (int)juce::dsp::SIMDRegister<SampleType>::SIMDNumElements;
+
+    //the branch count is rounded up to whole registers; the spare branches have zero coefficients and stay silent
+    static constexpr int maxBranches = (NumSlots + vectorSize - 1) / vectorSize * vectorSize;
+
+    struct Branches
+    {
+        std::array<SampleType, maxBranches> b0{}, b1{}, a1{}, a2{};
+        SampleType directGain{ 0 };
+    };
+
+    void setBranches(const Expansion& expansion, int rampLengthInSamples)
+    {
+        rampSamplesRemaining = juce::jmax(0, rampLengthInSamples);
+        numBranches = 0;
+
+        const auto scale = rampSamplesRemaining > 0 ? SampleType(1) / SampleType(rampSamplesRemaining) : SampleType(0);
+
+        target.directGain = static_cast<SampleType>(expansion.directGain);
+        step.directGain = (target.directGain - current.directGain) * scale;
+
+        for (int slot = 0; slot < NumSlots; ++slot)
+        {
+            const auto& branch = expansion.branches[(size_t)slot];
+            const bool isActive = expansion.active[(size_t)slot];
+
+            target.b0[(size_t)slot] = isActive ? static_cast<SampleType>(branch.b0) : SampleType(0);
+            target.b1[(size_t)slot] = isActive ? static_cast<SampleType>(branch.b1) : SampleType(0);
+            target.a1[(size_t)slot] = isActive ? static_cast<SampleType>(branch.a1) : SampleType(0);
+            target.a2[(size_t)slot] = isActive ? static_cast<SampleType>(branch.a2) : SampleType(0);
+
+            if (!isActive || rampSamplesRemaining == 0 || !wasActive[(size_t)slot])
+            {
+                //a branch that switches back on later should start from silence
+                if (!isActive)
+                    clearBranchState(slot);
+
+                current.b0[(size_t)slot] = target.b0[(size_t)slot];
+                current.b1[(size_t)slot] = target.b1[(size_t)slot];
+                current.a1[(size_t)slot] = target.a1[(size_t)slot];
+                current.a2[(size_t)slot] = target.a2[(size_t)slot];
+            }
+
+            step.b0[(size_t)slot] = (target.b0[(size_t)slot] - current.b0[(size_t)slot]) * scale;
+            step.b1[(size_t)slot] = (target.b1[(size_t)slot] - current.b1[(size_t)slot]) * scale;
+            step.a1[(size_t)slot] = (target.a1[(size_t)slot] - current.a1[(size_t)slot]) * scale;
+            step.a2[(size_t)slot] = (target.a2[(size_t)slot] - current.a2[(size_t)slot]) * scale;
+
+            wasActive[(size_t)slot] = isActive;
+
+            if (isActive)
+                numBranches = (slot / vectorSize + 1) * vectorSize;
+        }
+
+        if (rampSamplesRemaining == 0)
+            current.directGain = target.directGain;
+    }
+
+    void clearBranchState(int slot)
+    {
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            state1[(size_t)(lane * maxBranches + slot)] = SampleType(0);
+            state2[(size_t)(lane * maxBranches + slot)] = SampleType(0);
+        }
+    }
+
+    void processForm(bool parallel, juce::AudioBuffer<SampleType>& buffer, int startChannel, int numChannels)
+    {
+        if (parallel)
+            processBranches(buffer, startChannel, numChannels);
+        else
+            serial.process(buffer, startChannel, numChannels);
+    }
+
+    /** Runs the outgoing form on a copy of the block and the incoming one in place, then blends them. */
+    void processFading(juce::AudioBuffer<SampleType>& block, int numChannels)
+    {
+        const auto numSamples = block.getNumSamples();
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            fadeBuffer.copyFrom(channel, 0, block, channel, 0, numSamples);
+
+        juce::AudioBuffer<SampleType> outgoing(fadeBuffer.getArrayOfWritePointers(), numChannels, numSamples);
+        processForm(!useParallel, outgoing, 0, numChannels);
+        processForm(useParallel, block, 0, numChannels);
+
+        const auto fadeSamples = juce::jmin(numSamples, fadeSamplesRemaining);
+        const auto first = fadeLength - fadeSamplesRemaining;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* incoming = block.getWritePointer(channel);
+            const auto* faded = outgoing.getReadPointer(channel);
+
+            for (int i = 0; i < fadeSamples; ++i)
+            {
+                const auto gain = SampleType(first + i + 1) / SampleType(fadeLength);
+                incoming[i] = faded[i] + gain * (incoming[i] - faded[i]);
+            }
+        }
+
+        fadeSamplesRemaining -= fadeSamples;
+    }
+
+    void processBranches(juce::AudioBuffer<SampleType>& buffer, int startChannel, int numChannels)
+    {
+        const auto numSamples = buffer.getNumSamples();
+        const auto rampSamples = juce::jmin(numSamples, rampSamplesRemaining);
+
+        Branches c;
+
+        //every channel walks the same ramp from the same starting point
+        for (int lane = 0; lane < numChannels; ++lane)
+        {
+            auto* samples = buffer.getWritePointer(startChannel + lane);
+
+            c = processLane(lane, numSamples, rampSamples,
+                            [samples](int i) { return samples[i]; },
+                            [samples](int i, SampleType filtered) { samples[i] = filtered; });
+        }
+
+        current = c;
+        rampSamplesRemaining -= rampSamples;
+    }
+
+    /** Runs one lane's samples, as read and written by the given functions, through the branches from
+        the current coefficients, and returns the coefficients the lane ends on.
+    */
+    template<typename Read, typename Write>
+    Branches processLane(int lane, int numSamples, int rampSamples, Read&& read, Write&& write)
+    {
+        auto* s1 = state1.data() + lane * maxBranches;
+        auto* s2 = state2.data() + lane * maxBranches;
+
+        auto c = current;
+        int i = 0;
+
+        for (; i < rampSamples; ++i)
+        {
+            write(i, processSample(read(i), s1, s2, c));
+            advance(c);
+        }
+
+        //land exactly on the design rather than on the accumulated steps
+        if (rampSamples > 0 && rampSamples == rampSamplesRemaining)
+            c = target;
+
+        for (; i < numSamples; ++i)
+            write(i, processSample(read(i), s1, s2, c));
+
+        return c;
+    }
+
+    SampleType processSample(SampleType x, SampleType* s1, SampleType* s2, const Branches& c) const
+    {
+        alignas(16) std::array<SampleType, maxBranches> outputs;
+
+        //one branch per lane; with no dependency between the branches this loop vectorises
+        for (int branch = 0; branch < numBranches; ++branch)
+        {
+            const auto y = c.b0[(size_t)branch] * x + s1[branch];
+            s1[branch] = c.b1[(size_t)branch] * x - c.a1[(size_t)branch] * y + s2[branch];
+            s2[branch] = -c.a2[(size_t)branch] * y;
+            outputs[(size_t)branch] = y;
+        }
+
+        auto y = c.directGain * x;
+
+        for (int branch = 0; branch < numBranches; ++branch)
+            y += outputs[(size_t)branch];
+
+        return y;
+    }
+
+    void advance(Branches& c) const
+    {
+        for (int branch = 0; branch < numBranches; ++branch)
+        {
+            c.b0[(size_t)branch] += step.b0[(size_t)branch];
+            c.b1[(size_t)branch] += step.b1[(size_t)branch];
+            c.a1[(size_t)branch] += step.a1[(size_t)branch];
+            c.a2[(size_t)branch] += step.a2[(size_t)branch];
+        }
+
+        c.directGain += step.directGain;
+    }
+
+    BiquadCascade<SampleType, NumSlots> serial;
+    bool useParallel = false;
+
+    Branches current, target, step;
+    std::array<bool, NumSlots> wasActive{};
+    int numBranches = 0;
+    int rampSamplesRemaining = 0;
+
+    std::vector<SampleType> state1, state2;
+    int numLanes = 0;
+
+    juce::AudioBuffer<SampleType> fadeBuffer;
+    int fadeLength = 1, fadeSamplesRemaining = 0;
+};
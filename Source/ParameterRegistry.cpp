@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    ParameterRegistry.cpp
+
+  ==============================================================================
+*/
+
+#include "ParameterRegistry.h"
+
+namespace
+{
+    template<typename GetValue>
+    ChainSettings loadChainSettings(GetValue&& getValue)
+    {
+        ChainSettings settings;
+
+        settings.lowCutFreq         =   getValue(Param_LowCutFreq);
+        settings.highCutFreq        =   getValue(Param_HighCutFreq);
+        settings.peakFreq           =   getValue(Param_PeakFreq);
+        settings.peakGainInDecibels =   getValue(Param_PeakGain);
+        settings.peakQuality        =   getValue(Param_PeakQuality);
+        settings.lowCutSlope        =   static_cast<Slope>(getValue(Param_LowCutSlope));
+        settings.highCutSlope       =   static_cast<Slope>(getValue(Param_HighCutSlope));
+
+        settings.lowCutBypassed     =   getValue(Param_LowCutBypass) > 0.5f;
+        settings.highCutBypassed    =   getValue(Param_HighCutBypass) > 0.5f;
+        settings.peakBypassed       =   getValue(Param_PeakBypass) > 0.5f;
+        settings.globalBypassed     =   getValue(Param_GlobalBypass) > 0.5f;
+        settings.linearPhase        =   getValue(Param_LinearPhase) > 0.5f;
+        settings.processingMode     =   static_cast<ProcessingMode>(getValue(Param_ProcessingMode));
+        settings.topology           =   static_cast<FilterTopology>(getValue(Param_FilterTopology));
+        settings.matchedResponse    =   getValue(Param_MatchedResponse) > 0.5f;
+        settings.oversamplingFactor =   static_cast<OversamplingFactor>(getValue(Param_Oversampling));
+        settings.oversamplingFilter =   static_cast<OversamplingFilter>(getValue(Param_OversamplingFilter));
+        settings.oversamplingThreshold = getValue(Param_OversamplingThreshold);
+        //settings.AnalyzerEnabled    =   getValue(Param_AnalyzerEnabled) > 0.5f;
+
+        return settings;
+    }
+
+    //both tables describe a parameter with the same fields
+    template<typename Info>
+    void addParameter(juce::AudioProcessorValueTreeState::ParameterLayout& layout, const juce::String& id, const Info& info, float defaultValue)
+    {
+        switch (info.kind)
+        {
+        case ParameterKind::Float:
+            layout.add(std::make_unique<juce::AudioParameterFloat>(id, id,
+                juce::NormalisableRange<float>(info.minimum, info.maximum, info.interval, info.skew), defaultValue));
+            break;
+
+        case ParameterKind::Choice:
+            layout.add(std::make_unique<juce::AudioParameterChoice>(id, id, info.getChoices(), (int)defaultValue));
+            break;
+
+        case ParameterKind::Bool:
+            layout.add(std::make_unique<juce::AudioParameterBool>(id, id, defaultValue > 0.5f));
+            break;
+        }
+    }
+}
+
+void addParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout)
+{
+    for (const auto& info : parameterTable)
+        addParameter(layout, info.id, info, info.defaultValue);
+
+    for (int band = 0; band < MaxBands; ++band)
+    {
+        for (const auto& info : bandParameterTable)
+            addParameter(layout, getBandParameterID(band, info.parameter), info, getBandParameterDefault(band, info.parameter));
+    }
+}
+
+ParameterHandles getParameterHandles(juce::AudioProcessorValueTreeState& apvts)
+{
+    ParameterHandles handles;
+
+    for (const auto& info : parameterTable)
+    {
+        handles.values[(size_t)info.index] = apvts.getRawParameterValue(info.id);
+        jassert(handles.values[(size_t)info.index] != nullptr);
+    }
+
+    return handles;
+}
+
+ChainSettings getChainSettings(const ParameterHandles& handles)
+{
+    return loadChainSettings([&handles](ParameterIndex index) { return handles[index]; });
+}
+
+ChainSettings getChainSettings(const std::function<float(juce::StringRef)>& getParameterValue)
+{
+    return loadChainSettings([&getParameterValue](ParameterIndex index) { return getParameterValue(getParameterID(index)); });
+}
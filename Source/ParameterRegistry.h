@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    ParameterRegistry.h
+    One table of every parameter outside the parametric bands: its ID, kind,
+    range and default. The layout is generated from it, the processor and
+    editor read values through handles resolved from it once, and the
+    editor's attachments take their IDs from it, so no parameter name is
+    repeated by hand. The bands keep their own generated IDs and handle
+    table in ParametricBands.h.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <functional>
+#include "ChainSettings.h"
+#include "ChannelWorkerPool.h"
+#include "ControlRateScheduler.h"
+
+//in the order the host sees them; changing it renumbers the host's parameters
+enum ParameterIndex
+{
+    Param_LowCutFreq,
+    Param_HighCutFreq,
+    Param_PeakFreq,
+    Param_PeakGain,
+    Param_PeakQuality,
+    Param_LowCutSlope,
+    Param_HighCutSlope,
+    Param_LowCutBypass,
+    Param_HighCutBypass,
+    Param_PeakBypass,
+    Param_AnalyzerEnabled,
+    Param_GlobalBypass,
+    Param_LinearPhase,
+    Param_ProcessingMode,
+    Param_FilterTopology,
+    Param_MatchedResponse,
+    Param_Oversampling,
+    Param_OversamplingFilter,
+    Param_OversamplingThreshold,
+    Param_Threading,
+    Param_ControlRate,
+    Param_MorphEnabled,
+    Param_Morph,
+    Param_Deterministic,
+    NumParameters
+};
+
+struct ParameterInfo
+{
+    ParameterIndex index;
+    const char* id;
+    ParameterKind kind;
+
+    //the range of a float parameter
+    float minimum, maximum, interval, skew;
+
+    //the plain default: the value of a float, the index of a choice, 0 or 1 for a switch
+    float defaultValue;
+
+    juce::StringArray (*getChoices)();
+};
+
+constexpr ParameterInfo makeFloatParameter(ParameterIndex index, const char* id, float minimum, float maximum,
+                                           float interval, float skew, float defaultValue)
+{
+    return { index, id, ParameterKind::Float, minimum, maximum, interval, skew, defaultValue, nullptr };
+}
+
+constexpr ParameterInfo makeChoiceParameter(ParameterIndex index, const char* id, juce::StringArray (*getChoices)(), int defaultIndex)
+{
+    return { index, id, ParameterKind::Choice, 0.f, 1.f, 1.f, 1.f, (float)defaultIndex, getChoices };
+}
+
+constexpr ParameterInfo makeBoolParameter(ParameterIndex index, const char* id, bool defaultValue)
+{
+    return { index, id, ParameterKind::Bool, 0.f, 1.f, 1.f, 1.f, defaultValue ? 1.f : 0.f, nullptr };
+}
+
+inline constexpr std::array<ParameterInfo, NumParameters> parameterTable
+{
+    makeFloatParameter(Param_LowCutFreq,            "LowCut Freq",              20.f, 20000.f, 1.f, 0.25f, 20.f),
+    makeFloatParameter(Param_HighCutFreq,           "HighCut Freq",             20.f, 20000.f, 1.f, 0.25f, 20000.f),
+    makeFloatParameter(Param_PeakFreq,              "Peak Freq",                20.f, 20000.f, 1.f, 0.25f, 750.f),
+    makeFloatParameter(Param_PeakGain,              "Peak Gain",                -24.f, 24.f, 0.5f, 1.f, 0.f),
+    makeFloatParameter(Param_PeakQuality,           "Peak Quality",             0.1f, 10.f, 0.05f, 1.f, 1.f),
+    makeChoiceParameter(Param_LowCutSlope,          "LowCut Slope",             getSlopeNames, Slope_12),
+    makeChoiceParameter(Param_HighCutSlope,         "HighCut Slope",            getSlopeNames, Slope_12),
+    makeBoolParameter(Param_LowCutBypass,           "LowCut Bypass",            false),
+    makeBoolParameter(Param_HighCutBypass,          "HighCut Bypass",           false),
+    makeBoolParameter(Param_PeakBypass,             "Peak Bypass",              false),
+    makeBoolParameter(Param_AnalyzerEnabled,        "Analyzer Enabled",         true),
+    makeBoolParameter(Param_GlobalBypass,           "Global Bypass",            false),
+    makeBoolParameter(Param_LinearPhase,            "Linear Phase",             false),
+    makeChoiceParameter(Param_ProcessingMode,       "Processing Mode",          getProcessingModeNames, Mode_Stereo),
+    makeChoiceParameter(Param_FilterTopology,       "Filter Topology",          getFilterTopologyNames, Topology_Biquad),
+    makeBoolParameter(Param_MatchedResponse,        "Matched Response",         false),
+    makeChoiceParameter(Param_Oversampling,         "Oversampling",             getOversamplingFactorNames, Oversampling_Off),
+    makeChoiceParameter(Param_OversamplingFilter,   "Oversampling Filter",      getOversamplingFilterNames, OversamplingFilter_IIR),
+    makeFloatParameter(Param_OversamplingThreshold, "Oversampling Threshold",   0.1f, 1.f, 0.01f, 1.f, 0.5f),
+    makeChoiceParameter(Param_Threading,            "Threading",                getThreadingModeNames, Threading_Off),
+    makeChoiceParameter(Param_ControlRate,          "Control Rate",             getControlRateNames, 0),
+    makeBoolParameter(Param_MorphEnabled,           "Morph Enabled",            false),
+    makeFloatParameter(Param_Morph,                 "Morph",                    0.f, 1.f, 0.001f, 1.f, 0.f),
+    makeBoolParameter(Param_Deterministic,          "Deterministic Render",     false)
+};
+
+constexpr bool isParameterTableInOrder()
+{
+    for (size_t index = 0; index < parameterTable.size(); ++index)
+    {
+        if (parameterTable[index].index != (ParameterIndex)index)
+            return false;
+    }
+
+    return true;
+}
+
+static_assert(isParameterTableInOrder(), "every parameter must sit at its own index in parameterTable");
+
+constexpr const char* getParameterID(ParameterIndex index) { return parameterTable[(size_t)index].id; }
+
+/** Whether a preset carries the parameter. Presets hold the shape of the EQ: the cut and peak filters, every
+    band, and the matched design their stored sections were drawn with. The modes and engine settings are
+    left where the session has them.
+*/
+constexpr bool isPresetParameter(ParameterIndex index)
+{
+    return index <= Param_PeakBypass || index == Param_MatchedResponse;
+}
+
+/** Adds every parameter in the table to the layout, in table order, followed by every band's parameters from bandParameterTable. */
+void addParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout);
+
+/** Handles for every parameter in the table, resolved once so nothing reads a parameter by name while processing. */
+struct ParameterHandles
+{
+    std::array<std::atomic<float>*, NumParameters> values{};
+
+    float operator[](ParameterIndex index) const { return values[(size_t)index]->load(); }
+};
+
+ParameterHandles getParameterHandles(juce::AudioProcessorValueTreeState& apvts);
+
+/** Reads the settings through the handles. The bands are left alone; those come from loadBandSettings. */
+ChainSettings getChainSettings(const ParameterHandles& handles);
+
+/** The same, from any source of plain parameter values by ID. */
+ChainSettings getChainSettings(const std::function<float(juce::StringRef)>& getParameterValue);
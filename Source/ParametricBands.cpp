@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    ParametricBands.cpp
+
+  ==============================================================================
+*/
+
+#include "ParametricBands.h"
+
+juce::String getBandParameterID(int bandIndex, BandParameter parameter)
+{
+    juce::String str;
+    str << "Band" << (bandIndex + 1) << ' ' << bandParameterTable[(size_t)parameter].suffix;
+    return str;
+}
+
+float getBandParameterDefault(int bandIndex, BandParameter parameter)
+{
+    const auto& info = bandParameterTable[(size_t)parameter];
+
+    if (parameter == BandFreq)
+        return std::round(juce::mapToLog10((bandIndex + 0.5f) / MaxBands, info.minimum, info.maximum));
+
+    return info.defaultValue;
+}
+
+juce::StringArray getBandTypeNames()
+{
+    return { "Peak", "Low Shelf", "High Shelf", "Low Cut", "High Cut" };
+}
+
+BandParameterTable getBandParameterHandles(juce::AudioProcessorValueTreeState& apvts)
+{
+    BandParameterTable table;
+
+    for (int band = 0; band < MaxBands; ++band)
+    {
+        for (int parameter = 0; parameter < NumBandParameters; ++parameter)
+        {
+            table[band].parameters[parameter] = apvts.getRawParameterValue(getBandParameterID(band, static_cast<BandParameter>(parameter)));
+            jassert(table[band].parameters[parameter] != nullptr);
+        }
+    }
+
+    return table;
+}
+
+void loadBandSettings(const BandParameterTable& table, std::array<BandSettings, MaxBands>& bands)
+{
+    for (int band = 0; band < MaxBands; ++band)
+    {
+        const auto& handles = table[band].parameters;
+        auto& settings = bands[band];
+
+        settings.enabled        =   handles[BandEnabled]->load() > 0.5f;
+        settings.type           =   static_cast<BandType>(handles[BandTypeChoice]->load());
+        settings.freq           =   handles[BandFreq]->load();
+        settings.gainInDecibels =   handles[BandGain]->load();
+        settings.quality        =   handles[BandQuality]->load();
+    }
+}
+
+void loadBandSettings(const std::function<float(juce::StringRef)>& getParameterValue, std::array<BandSettings, MaxBands>& bands)
+{
+    for (int band = 0; band < MaxBands; ++band)
+    {
+        auto& settings = bands[band];
+
+        settings.enabled        =   getParameterValue(getBandParameterID(band, BandEnabled)) > 0.5f;
+        settings.type           =   static_cast<BandType>(getParameterValue(getBandParameterID(band, BandTypeChoice)));
+        settings.freq           =   getParameterValue(getBandParameterID(band, BandFreq));
+        settings.gainInDecibels =   getParameterValue(getBandParameterID(band, BandGain));
+        settings.quality        =   getParameterValue(getBandParameterID(band, BandQuality));
+    }
+}
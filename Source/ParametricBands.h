@@ -0,0 +1,200 @@
+/*
+  ==============================================================================
+
+    ParametricBands.h
+    Variable-count parametric bands that run after the fixed cut/peak chain.
+    Each active band becomes one section of the engine's cascade.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <functional>
+#include "BiquadCascade.h"
+#include "SVFCascade.h"
+#include "MatchedDesign.h"
+#include "CoefficientCache.h"
+
+static constexpr int MaxBands = 16;
+
+enum BandType
+{
+    Band_Peak,
+    Band_LowShelf,
+    Band_HighShelf,
+    Band_LowCut,
+    Band_HighCut
+};
+
+enum BandParameter
+{
+    BandEnabled,
+    BandTypeChoice,
+    BandFreq,
+    BandGain,
+    BandQuality,
+    NumBandParameters
+};
+
+//shared with parameterTable in ParameterRegistry.h, which includes this header
+enum class ParameterKind
+{
+    Float,
+    Choice,
+    Bool
+};
+
+juce::StringArray getBandTypeNames();
+
+/** One parameter of a band. Every band gets one of each, named "Band<n> <suffix>". */
+struct BandParameterInfo
+{
+    BandParameter parameter;
+    const char* suffix;
+    ParameterKind kind;
+
+    //the range of a float parameter
+    float minimum, maximum, interval, skew;
+
+    //the plain default, as in ParameterInfo; the frequency's is replaced by getBandParameterDefault
+    float defaultValue;
+
+    juce::StringArray (*getChoices)();
+};
+
+inline constexpr std::array<BandParameterInfo, NumBandParameters> bandParameterTable
+{ {
+    { BandEnabled,      "Enabled",  ParameterKind::Bool,    0.f, 1.f, 1.f, 1.f,             0.f,                nullptr },
+    { BandTypeChoice,   "Type",     ParameterKind::Choice,  0.f, 1.f, 1.f, 1.f,             (float)Band_Peak,   getBandTypeNames },
+    { BandFreq,         "Freq",     ParameterKind::Float,   20.f, 20000.f, 1.f, 0.25f,      1000.f,             nullptr },
+    { BandGain,         "Gain",     ParameterKind::Float,   -24.f, 24.f, 0.5f, 1.f,         0.f,                nullptr },
+    { BandQuality,      "Quality",  ParameterKind::Float,   0.1f, 10.f, 0.05f, 1.f,         1.f,                nullptr }
+} };
+
+constexpr bool isBandParameterTableInOrder()
+{
+    for (size_t index = 0; index < bandParameterTable.size(); ++index)
+    {
+        if (bandParameterTable[index].parameter != (BandParameter)index)
+            return false;
+    }
+
+    return true;
+}
+
+static_assert(isBandParameterTableInOrder(), "every band parameter must sit at its own index in bandParameterTable");
+
+juce::String getBandParameterID(int bandIndex, BandParameter parameter);
+
+/** The table's default, except that the band frequencies are spread evenly over the log range. */
+float getBandParameterDefault(int bandIndex, BandParameter parameter);
+
+struct BandSettings
+{
+    BandType    type{ Band_Peak };
+    float       freq{ 1000.f },     gainInDecibels{ 0 },    quality{ 1.f };
+    bool        enabled{ false };
+};
+
+inline bool operator==(const BandSettings& a, const BandSettings& b)
+{
+    return a.type == b.type && a.freq == b.freq && a.gainInDecibels == b.gainInDecibels
+        && a.quality == b.quality && a.enabled == b.enabled;
+}
+
+inline bool operator!=(const BandSettings& a, const BandSettings& b) { return !(a == b); }
+
+/** True when the band is switched on and actually changes the signal. */
+inline bool isBandActive(const BandSettings& band)
+{
+    if (!band.enabled)
+        return false;
+
+    if (band.type == Band_LowCut || band.type == Band_HighCut)
+        return true;
+
+    return std::abs(band.gainInDecibels) >= 0.01f;
+}
+
+/** Parameter handles for every band, resolved once so the audio thread never looks parameters up by name. */
+struct BandParameterHandles
+{
+    std::atomic<float>* parameters[NumBandParameters]{};
+};
+
+using BandParameterTable = std::array<BandParameterHandles, MaxBands>;
+
+BandParameterTable getBandParameterHandles(juce::AudioProcessorValueTreeState& apvts);
+void loadBandSettings(const BandParameterTable& table, std::array<BandSettings, MaxBands>& bands);
+
+/** The same, from any source of plain parameter values by ID. */
+void loadBandSettings(const std::function<float(juce::StringRef)>& getParameterValue, std::array<BandSettings, MaxBands>& bands);
+
+//==============================================================================
+/** The matched-response design of a peak or shelf band, or false for the cut types, which have no gain to match. */
+inline bool makeMatchedBandCoefficients(const BandSettings& band, double sampleRate, BiquadCoefficients<double>& coefficients)
+{
+    CoefficientCache::DesignType type;
+
+    switch (band.type)
+    {
+    case Band_Peak:         type = CoefficientCache::Design_MatchedPeak; break;
+    case Band_LowShelf:     type = CoefficientCache::Design_MatchedLowShelf; break;
+    case Band_HighShelf:    type = CoefficientCache::Design_MatchedHighShelf; break;
+    default:                return false;
+    }
+
+    CoefficientCache::Design design;
+    CoefficientCache::getInstance().getDesign({ type, 2, band.freq, band.quality, band.gainInDecibels, sampleRate }, design);
+    coefficients = design.sections[0];
+    return true;
+}
+
+template<typename SampleType>
+BiquadCoefficients<SampleType> makeBandCoefficients(const BandSettings& band, double sampleRate, bool matchedResponse = false)
+{
+    using Design = juce::dsp::IIR::ArrayCoefficients<SampleType>;
+
+    BiquadCoefficients<double> matched;
+    if (matchedResponse && makeMatchedBandCoefficients(band, sampleRate, matched))
+        return MatchedDesign::toPrecision<SampleType>(matched);
+
+    //keep the design below nyquist when the host runs at a low sample rate
+    const auto freq = static_cast<SampleType>(juce::jmin(double(band.freq), sampleRate * 0.49));
+    const auto quality = static_cast<SampleType>(band.quality);
+    const auto gain = juce::Decibels::decibelsToGain(static_cast<SampleType>(band.gainInDecibels));
+
+    switch (band.type)
+    {
+    case Band_LowShelf:     return makeBiquadCoefficients(Design::makeLowShelf(sampleRate, freq, quality, gain));
+    case Band_HighShelf:    return makeBiquadCoefficients(Design::makeHighShelf(sampleRate, freq, quality, gain));
+    case Band_LowCut:       return makeBiquadCoefficients(Design::makeHighPass(sampleRate, freq, quality));
+    case Band_HighCut:      return makeBiquadCoefficients(Design::makeLowPass(sampleRate, freq, quality));
+    case Band_Peak:
+    default:                return makeBiquadCoefficients(Design::makePeakFilter(sampleRate, freq, quality, gain));
+    }
+}
+
+template<typename SampleType>
+SVFCoefficients<SampleType> makeSVFBandCoefficients(const BandSettings& band, double sampleRate, bool matchedResponse = false)
+{
+    BiquadCoefficients<double> matched;
+    if (matchedResponse && makeMatchedBandCoefficients(band, sampleRate, matched))
+        return SVFDesign::fromBiquad<SampleType>(matched);
+
+    const auto quality = static_cast<SampleType>(band.quality);
+    const auto gain = juce::Decibels::decibelsToGain(static_cast<SampleType>(band.gainInDecibels));
+
+    switch (band.type)
+    {
+    case Band_LowShelf:     return SVFDesign::makeLowShelf(sampleRate, band.freq, quality, gain);
+    case Band_HighShelf:    return SVFDesign::makeHighShelf(sampleRate, band.freq, quality, gain);
+    case Band_LowCut:       return SVFDesign::makeHighPass(sampleRate, band.freq, quality);
+    case Band_HighCut:      return SVFDesign::makeLowPass(sampleRate, band.freq, quality);
+    case Band_Peak:
+    default:                return SVFDesign::makePeakFilter(sampleRate, band.freq, quality, gain);
+    }
+}
@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    PeakCoefficientTable.cpp
+
+  ==============================================================================
+*/
+
+#include "PeakCoefficientTable.h"
+
+void PeakCoefficientTable::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    maxFrequency = sampleRate * 0.49;
+    logFrequencyRange = std::log2(maxFrequency / minFrequency);
+
+    cosTable.resize((size_t)numFrequencyPoints);
+    sinTable.resize((size_t)numFrequencyPoints);
+
+    for (int i = 0; i < numFrequencyPoints; ++i)
+    {
+        const auto freq = minFrequency * std::exp2(logFrequencyRange * i / (numFrequencyPoints - 1));
+        const auto omega = juce::MathConstants<double>::twoPi * freq / sampleRate;
+
+        cosTable[(size_t)i] = std::cos(omega);
+        sinTable[(size_t)i] = std::sin(omega);
+    }
+
+    gainTable.resize((size_t)numGainPoints);
+
+    for (int i = 0; i < numGainPoints; ++i)
+    {
+        const auto decibels = minGainInDecibels + (maxGainInDecibels - minGainInDecibels) * i / (numGainPoints - 1);
+        gainTable[(size_t)i] = std::pow(10.0, decibels / 40.0);
+    }
+}
+
+bool PeakCoefficientTable::lookUp(double rate, double frequency, double gainInDecibels, double& cosOmega, double& sinOmega, double& A) const
+{
+    if (!isPrepared() || rate != sampleRate || frequency < minFrequency || frequency > maxFrequency
+        || gainInDecibels < minGainInDecibels || gainInDecibels > maxGainInDecibels)
+        return false;
+
+    const auto frequencyPosition = std::log2(frequency / minFrequency) / logFrequencyRange * (numFrequencyPoints - 1);
+    const auto gainPosition = (gainInDecibels - minGainInDecibels) / (maxGainInDecibels - minGainInDecibels) * (numGainPoints - 1);
+
+    cosOmega = interpolate(cosTable, frequencyPosition);
+    sinOmega = interpolate(sinTable, frequencyPosition);
+    A = interpolate(gainTable, gainPosition);
+    return true;
+}
@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    PeakCoefficientTable.h
+    Precomputed, interpolated design data for peak filters at one sample rate.
+    The RBJ peak factors into a frequency term (the sine and cosine of the
+    centre frequency), a gain term (A = 10^(dB/40)) and Q, which enters
+    exactly through a division. So instead of a three-dimensional grid over
+    (frequency, gain, Q), two small one-dimensional tables give the same
+    coverage for a few kilobytes, and a design becomes two table lookups and
+    a handful of multiplies, with no trig, pow or allocation. The tables and
+    the arithmetic are double precision whatever the engine runs at: a low,
+    narrow peak in single precision is too ill-conditioned to survive the
+    interpolation otherwise.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "BiquadCascade.h"
+#include "SVFCascade.h"
+
+class PeakCoefficientTable
+{
+public:
+    static constexpr int numFrequencyPoints = 2048;
+    static constexpr double minFrequency = 10.0;
+
+    static constexpr int numGainPoints = 961;
+    static constexpr double minGainInDecibels = -24.0, maxGainInDecibels = 24.0;
+
+    /** Builds the tables for the sample rate. Call from prepareToPlay. */
+    void prepare(double newSampleRate);
+
+    bool isPrepared() const { return !gainTable.empty(); }
+
+    /** Designs an RBJ peak from the tables. Returns false, leaving the output
+        alone, when the tables were built for another sample rate or the
+        frequency or gain lies outside what they cover.
+    */
+    template<typename CoefficientType>
+    bool makePeakFilter(double rate, double frequency, double quality, double gainInDecibels, BiquadCoefficients<CoefficientType>& coefficients) const
+    {
+        double cosOmega, sinOmega, A;
+
+        if (!lookUp(rate, frequency, gainInDecibels, cosOmega, sinOmega, A))
+            return false;
+
+        const auto alpha = sinOmega / (2.0 * quality);
+        const auto a0 = 1.0 + alpha / A;
+
+        coefficients.b0 = static_cast<CoefficientType>((1.0 + alpha * A) / a0);
+        coefficients.b1 = static_cast<CoefficientType>(-2.0 * cosOmega / a0);
+        coefficients.b2 = static_cast<CoefficientType>((1.0 - alpha * A) / a0);
+        coefficients.a1 = coefficients.b1;
+        coefficients.a2 = static_cast<CoefficientType>((1.0 - alpha / A) / a0);
+        return true;
+    }
+
+    /** The same peak for the SVF topology; its prewarped cutoff tan(omega / 2) comes out of the same tables. */
+    template<typename CoefficientType>
+    bool makePeakFilter(double rate, double frequency, double quality, double gainInDecibels, SVFCoefficients<CoefficientType>& coefficients) const
+    {
+        double cosOmega, sinOmega, A;
+
+        if (!lookUp(rate, frequency, gainInDecibels, cosOmega, sinOmega, A))
+            return false;
+
+        const auto g = sinOmega / (1.0 + cosOmega);
+        const auto k = 1.0 / (quality * A);
+
+        coefficients = SVFDesign::make(static_cast<CoefficientType>(g), static_cast<CoefficientType>(k), CoefficientType(1),
+                                       static_cast<CoefficientType>(k * (A * A - 1.0)), CoefficientType(0));
+        return true;
+    }
+
+private:
+    bool lookUp(double rate, double frequency, double gainInDecibels, double& cosOmega, double& sinOmega, double& A) const;
+
+    static double interpolate(const std::vector<double>& table, double position)
+    {
+        const auto index = juce::jlimit(0, (int)table.size() - 2, (int)position);
+        const auto fraction = position - index;
+
+        return table[(size_t)index] + fraction * (table[(size_t)index + 1] - table[(size_t)index]);
+    }
+
+    double sampleRate = 0.0, maxFrequency = 0.0, logFrequencyRange = 1.0;
+    std::vector<double> cosTable, sinTable, gainTable;
+};
@@ -205,6 +205,8 @@ juce::String RotartySliderWithLabels::getDisplayString() const
 //============================================================================== 
 
 ResponseCurveComponent::ResponseCurveComponent(SimpleEQAudioProcessor& p) : audioProcessor(p),
+parameters(getParameterHandles(audioProcessor.apvts)),
+bandParameters(getBandParameterHandles(audioProcessor.apvts)),
 leftPathProducer(audioProcessor.leftChannelFifo),
 rightPathProducer(audioProcessor.rightChannelFifo)
 {
@@ -294,20 +296,20 @@ void ResponseCurveComponent::timerCallback()
 
 void ResponseCurveComponent::updateChain()
 {
-    auto chainSettings = getChainSettings(audioProcessor.apvts);
+    showsMorph = audioProcessor.getMorphedSections(morphedSections, audioProcessor.getSampleRate());
 
-    monoChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
-    monoChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
-    monoChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
+    auto chainSettings = getChainSettings(parameters);
 
+    updateMonoChain(monoChain, chainSettings, audioProcessor.getSampleRate());
 
-    auto peakCoefficients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
+    loadBandSettings(bandParameters, chainSettings.bands);
 
-    updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
+    activeBandCoefficients.clear();
+    for (const auto& band : chainSettings.bands)
+    {
+        if (isBandActive(band))
+            activeBandCoefficients.push_back(makeBandCoefficients<double>(band, audioProcessor.getSampleRate(), chainSettings.matchedResponse));
+    }
 }
 
 void ResponseCurveComponent::paint(juce::Graphics& g)
@@ -322,10 +324,6 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
     auto responseArea = getAnalysisArea();
     auto w = responseArea.getWidth();
 
-    auto& lowcut = monoChain.get<ChainPositions::LowCut>();
-    auto& peak = monoChain.get<ChainPositions::Peak>();
-    auto& highcut = monoChain.get<ChainPositions::HighCut>();
-
     auto sampleRate = audioProcessor.getSampleRate();
 
     std::vector<double> mags;
@@ -333,35 +331,24 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
 
     for (int i = 0; i < w; i++)
     {
-        double mag = 1.f;
         auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
-        if (!monoChain.isBypassed<ChainPositions::Peak>())
-            mag *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
+        auto mag = 1.0;
 
-        if (!monoChain.isBypassed<ChainPositions::LowCut>())
+        if (showsMorph)
         {
-            if (!lowcut.isBypassed<0>())
-                mag *= lowcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!lowcut.isBypassed<1>())
-                mag *= lowcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!lowcut.isBypassed<2>())
-                mag *= lowcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!lowcut.isBypassed<3>())
-                mag *= lowcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+            for (int slot = 0; slot < MaxSections; ++slot)
+            {
+                if (morphedSections.active[slot])
+                    mag *= morphedSections.coefficients[slot].getMagnitudeForFrequency(freq, sampleRate);
+            }
         }
-
-        if (!monoChain.isBypassed<ChainPositions::HighCut>())
+        else
         {
-            if (!highcut.isBypassed<0>())
-                mag *= highcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!highcut.isBypassed<1>())
-                mag *= highcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!highcut.isBypassed<2>())
-                mag *= highcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!highcut.isBypassed<3>())
-                mag *= highcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
+            mag = getMagnitudeForFrequency(monoChain, freq, sampleRate);
 
+            for (const auto& band : activeBandCoefficients)
+                mag *= band.getMagnitudeForFrequency(freq, sampleRate);
+        }
 
         mags[i] = Decibels::gainToDecibels(mag);
     }
@@ -536,24 +523,24 @@ juce::Rectangle<int> ResponseCurveComponent::getAnalysisArea()
 //==============================================================================
 SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p), responseCurveComponent(audioProcessor),
-      peakFreqSlider(*audioProcessor.apvts.getParameter("Peak Freq"), "Hz"),
-      peakGainSlider(*audioProcessor.apvts.getParameter("Peak Gain"), "dB"),
-      peakQualitySlider(*audioProcessor.apvts.getParameter("Peak Quality"), ""),
-      lowCutFreqSlider(*audioProcessor.apvts.getParameter("LowCut Freq"), "Hz"),
-      highCutFreqSlider(*audioProcessor.apvts.getParameter("HighCut Freq"), "Hz"),
-      lowCutSlopeSlider(*audioProcessor.apvts.getParameter("LowCut Slope"), "dB/Oct"),
-      highCutSlopeSlider(*audioProcessor.apvts.getParameter("HighCut Slope"), "dB/Oct"),
-      peakFreqSliderAttachment(audioProcessor.apvts, "Peak Freq", peakFreqSlider),
-      peakGainSliderAttachment(audioProcessor.apvts, "Peak Gain", peakGainSlider),
-      peakQualitySliderAttachment(audioProcessor.apvts, "Peak Quality", peakQualitySlider),
-      lowCutFreqSliderAttachment(audioProcessor.apvts, "LowCut Freq", lowCutFreqSlider),
-      highCutFreqSliderAttachment(audioProcessor.apvts, "HighCut Freq", highCutFreqSlider),
-      lowCutSlopeSliderAttachment(audioProcessor.apvts, "LowCut Slope", lowCutSlopeSlider),
-      highCutSlopeSliderAttachment(audioProcessor.apvts,"HighCut Slope", highCutSlopeSlider),
-      lowcutBypassButtonAttachment(audioProcessor.apvts, "LowCut Bypass", lowcutBypassButton),
-      highcutBypassButtonAttachment(audioProcessor.apvts, "HighCut Bypass", highcutBypassButton),
-      peakBypassButtonAttachment(audioProcessor.apvts, "Peak Bypass", peakBypassButton),
-      analyzerEnabledButtonAttachment(audioProcessor.apvts, "Analyzer Enabled", analyzerEnabledButton)
+      peakFreqSlider(*audioProcessor.apvts.getParameter(getParameterID(Param_PeakFreq)), "Hz"),
+      peakGainSlider(*audioProcessor.apvts.getParameter(getParameterID(Param_PeakGain)), "dB"),
+      peakQualitySlider(*audioProcessor.apvts.getParameter(getParameterID(Param_PeakQuality)), ""),
+      lowCutFreqSlider(*audioProcessor.apvts.getParameter(getParameterID(Param_LowCutFreq)), "Hz"),
+      highCutFreqSlider(*audioProcessor.apvts.getParameter(getParameterID(Param_HighCutFreq)), "Hz"),
+      lowCutSlopeSlider(*audioProcessor.apvts.getParameter(getParameterID(Param_LowCutSlope)), "dB/Oct"),
+      highCutSlopeSlider(*audioProcessor.apvts.getParameter(getParameterID(Param_HighCutSlope)), "dB/Oct"),
+      peakFreqSliderAttachment(audioProcessor.apvts, getParameterID(Param_PeakFreq), peakFreqSlider),
+      peakGainSliderAttachment(audioProcessor.apvts, getParameterID(Param_PeakGain), peakGainSlider),
+      peakQualitySliderAttachment(audioProcessor.apvts, getParameterID(Param_PeakQuality), peakQualitySlider),
+      lowCutFreqSliderAttachment(audioProcessor.apvts, getParameterID(Param_LowCutFreq), lowCutFreqSlider),
+      highCutFreqSliderAttachment(audioProcessor.apvts, getParameterID(Param_HighCutFreq), highCutFreqSlider),
+      lowCutSlopeSliderAttachment(audioProcessor.apvts, getParameterID(Param_LowCutSlope), lowCutSlopeSlider),
+      highCutSlopeSliderAttachment(audioProcessor.apvts, getParameterID(Param_HighCutSlope), highCutSlopeSlider),
+      lowcutBypassButtonAttachment(audioProcessor.apvts, getParameterID(Param_LowCutBypass), lowcutBypassButton),
+      highcutBypassButtonAttachment(audioProcessor.apvts, getParameterID(Param_HighCutBypass), highcutBypassButton),
+      peakBypassButtonAttachment(audioProcessor.apvts, getParameterID(Param_PeakBypass), peakBypassButton),
+      analyzerEnabledButtonAttachment(audioProcessor.apvts, getParameterID(Param_AnalyzerEnabled), analyzerEnabledButton)
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
@@ -627,6 +614,28 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcess
         }
     };
 
+    storeSnapshotAButton.onClick = [safePtr]()
+    {
+        if (auto* comp = safePtr.getComponent())
+        {
+            comp->audioProcessor.storeSnapshot(0);
+
+            //while the morph is on the curve is drawn from the snapshots, so it redraws as for a parameter
+            comp->responseCurveComponent.parameterValueChanged(0, 0.f);
+        }
+    };
+
+    storeSnapshotBButton.onClick = [safePtr]()
+    {
+        if (auto* comp = safePtr.getComponent())
+        {
+            comp->audioProcessor.storeSnapshot(1);
+
+            //while the morph is on the curve is drawn from the snapshots, so it redraws as for a parameter
+            comp->responseCurveComponent.parameterValueChanged(0, 0.f);
+        }
+    };
+
     analyzerEnabledButton.onClick = [safePtr]()
     {
         if (auto* comp = safePtr.getComponent())
@@ -664,6 +673,12 @@ void SimpleEQAudioProcessorEditor::resized()
 
     auto bounds = getLocalBounds();
     auto analyzerEnabledArea = bounds.removeFromTop(25);
+
+    auto snapshotArea = analyzerEnabledArea.reduced(5, 2).removeFromRight(130);
+    storeSnapshotBButton.setBounds(snapshotArea.removeFromRight(62));
+    snapshotArea.removeFromRight(6);
+    storeSnapshotAButton.setBounds(snapshotArea);
+
     analyzerEnabledArea.setWidth(100);
     analyzerEnabledArea.setX(5);
     analyzerEnabledArea.removeFromTop(2);
@@ -709,7 +724,10 @@ std::vector<juce::Component*> SimpleEQAudioProcessorEditor::getComps()
         &lowcutBypassButton,
         &highcutBypassButton,
         &peakBypassButton,
-        &analyzerEnabledButton
+        &analyzerEnabledButton,
+
+        &storeSnapshotAButton,
+        &storeSnapshotBButton
     };
 }
 
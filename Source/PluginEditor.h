@@ -2,6 +2,8 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "KernelDispatch.h"
+#include "FFTBackend.h"
 
 enum FFTOrder
 {
@@ -21,19 +23,13 @@ struct FFTDataGenerator
         auto* readIndex = audioData.getReadPointer(0);
         std::copy(readIndex, readIndex + fftSize, fftData.begin());
 
-        window->multiplyWithWindowingTable(fftData.data(), fftSize);
-        forwardFFT->performFrequencyOnlyForwardTransform(fftData.data());
+        const auto& kernels = KernelDispatch::getSpectrumKernels();
+
+        kernels.applyWindow(fftData.data(), window.data(), fftSize);
+        forwardFFT->performMagnitudeTransform(fftData.data());
         int numBins = (int)fftSize / 2;
-        
-        for (int i = 0; i < numBins; ++i)
-        {
-            fftData[i] /= (float)numBins;
-        }
 
-        for (int i = 0; i < numBins; ++i)
-        {
-            fftData[i] = juce::Decibels::gainToDecibels(fftData[i], negativeInfinity);
-        }
+        kernels.magnitudesToDecibels(fftData.data(), numBins, 1.f / (float)numBins, negativeInfinity);
 
         fftDataFifo.push(fftData);
     }
@@ -42,8 +38,9 @@ struct FFTDataGenerator
     {
         order = newOrder;
         auto fftSize = getFFTSize();
-        forwardFFT = std::make_unique<juce::dsp::FFT>(order);
-        window = std::make_unique <juce::dsp::WindowingFunction<float>>(fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris);
+        forwardFFT = FFTBackend::create(order);
+        window.resize((size_t)fftSize);
+        juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), (size_t)fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris);
 
         fftData.clear();
         fftData.resize(fftSize * 2, 0);
@@ -56,8 +53,8 @@ struct FFTDataGenerator
 private:
     FFTOrder order;
     BlockType fftData;
-    std::unique_ptr<juce::dsp::FFT> forwardFFT;
-    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    std::unique_ptr<FFTBackend> forwardFFT;
+    std::vector<float> window;
 
     Fifo<BlockType> fftDataFifo;
 };
@@ -203,6 +200,13 @@ private:
     SimpleEQAudioProcessor& audioProcessor;
     juce::Atomic<bool> parametersChanged{ false };
     MonoChain monoChain;
+    ParameterHandles parameters;
+    BandParameterTable bandParameters;
+    std::vector<BiquadCoefficients<double>> activeBandCoefficients;
+
+    //while the morph is on, the curve is drawn from the blended sections alone
+    bool showsMorph = false;
+    EQSectionList<double> morphedSections;
     juce::Image background;
     juce::Rectangle<int> getRenderArea();
     juce::Rectangle<int> getAnalysisArea();
@@ -279,6 +283,10 @@ private:
                             highcutBypassButton;
     AnalyzerButton          analyzerEnabledButton;
 
+    //store the current settings as the morph's A and B snapshots
+    juce::TextButton        storeSnapshotAButton{ "Store A" },
+                            storeSnapshotBButton{ "Store B" };
+
     using ButtonAttachment = APVTS::ButtonAttachment;
 
     ButtonAttachment        lowcutBypassButtonAttachment,
@@ -22,10 +22,26 @@ SimpleEQAudioProcessor::SimpleEQAudioProcessor()
                        )
 #endif
 {
+    parameters = getParameterHandles(apvts);
+    bandParameters = getBandParameterHandles(apvts);
+
+    floatEngine.setLinearPhaseEQ(&linearPhaseEQ);
+    doubleEngine.setLinearPhaseEQ(&linearPhaseEQ);
+
+    floatEngine.setWorkerPool(&workerPool);
+    doubleEngine.setWorkerPool(&workerPool);
+
+    for (auto* parameter : getParameters())
+        parameter->addListener(this);
+
+    //the preset bank is loaded by the first update on the message thread
+    triggerAsyncUpdate();
 }
 
 SimpleEQAudioProcessor::~SimpleEQAudioProcessor()
 {
+    for (auto* parameter : getParameters())
+        parameter->removeListener(this);
 }
 
 //==============================================================================
@@ -63,31 +79,51 @@ bool SimpleEQAudioProcessor::isMidiEffect() const
 
 double SimpleEQAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return tailLengthSeconds.load();
 }
 
 int SimpleEQAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    const auto* bank = presetBank.load();
+    // NB: some hosts don't cope very well if you tell them there are 0 programs,
+    // so this should be at least 1, even if you're not really implementing programs.
+    return juce::jmax(1, bank != nullptr ? bank->getNumPresets() : 0);
 }
 
 int SimpleEQAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentProgram.load();
 }
 
 void SimpleEQAudioProcessor::setCurrentProgram (int index)
 {
+    const auto* bank = presetBank.load();
+    const auto* preset = bank != nullptr ? bank->getPreset(index) : nullptr;
+
+    if (preset == nullptr)
+        return;
+
+    currentProgram.store(index);
+
+    //published only once every value is in, so the tick that takes it reads the preset's settings whole
+    stateSerialiser.read(preset->state, preset->stateSize);
+    pendingPreset.store(preset);
+
+    //reselecting the current program moves nothing, but the pending preset still has to be taken
+    parameterGeneration.fetch_add(1);
 }
 
 const juce::String SimpleEQAudioProcessor::getProgramName (int index)
 {
-    return {};
+    const auto* bank = presetBank.load();
+    const auto* preset = bank != nullptr ? bank->getPreset(index) : nullptr;
+    return preset != nullptr ? preset->name : juce::String();
 }
 
 void SimpleEQAudioProcessor::changeProgramName (int index, const juce::String& newName)
 {
+    //the bank is mapped read-only, so its programs keep the names they were written with
+    juce::ignoreUnused(index, newName);
 }
 
 //==============================================================================
@@ -98,13 +134,40 @@ void SimpleEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
 
     juce::dsp::ProcessSpec spec;
     spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
+    spec.numChannels = (juce::uint32)getTotalNumOutputChannels();
     spec.sampleRate = sampleRate;
 
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    //with the pool in use the groups are narrowed so the bus splits across the cores, otherwise
+    //they stay a full SIMD width wide
+    const auto useWorkerPool = static_cast<ThreadingMode>(parameters[Param_Threading]) != Threading_Off;
+    const auto maxTasks = useWorkerPool ? juce::SystemStats::getNumCpus() : 1;
+    preparedForWorkerPool.store(useWorkerPool);
+
+    if (isUsingDoublePrecision())
+        doubleEngine.prepare(spec, maxTasks);
+    else
+        floatEngine.prepare(spec, maxTasks);
+
+    auto chainSettings = getChainSettings(parameters);
+    loadBandSettings(bandParameters, chainSettings.bands);
+    linearPhaseEQ.prepare(spec, chainSettings);
+
+    //one worker per extra channel group is as far as the engine can split a block
+    const auto numGroups = isUsingDoublePrecision() ? doubleEngine.getNumGroups() : floatEngine.getNumGroups();
+    numUsefulWorkers.store(juce::jmax(0, juce::jmin(juce::SystemStats::getNumCpus() - 1, numGroups - 1)));
+
+    if (getNumWorkersToUse() != workerPool.getNumWorkers())
+        workerPool.start(getNumWorkersToUse());
 
-    updateFilters();
+    controlScheduler.reset();
+    appliedParameterGeneration = parameterGeneration.load();
+    smoothedSettings.reset(sampleRate, chainSettings);
+    morphPosition.reset(sampleRate, SmoothedChainSettings::rampLengthInSeconds);
+    morphPosition.setCurrentAndTargetValue(parameters[Param_Morph]);
+    updateFilters(chainSettings, 0);
+
+    //updateFilters has worked out the latency of the current mode; here it can be reported straight away
+    setLatencySamples(latencyInSamples.load());
 
     leftChannelFifo.prepare(samplesPerBlock);
     rightChannelFifo.prepare(samplesPerBlock);
@@ -131,12 +194,10 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // The engine is channel-count generic, so any layout from mono up to
+    // surround, immersive and ambisonic formats is accepted as long as the
+    // main bus is enabled.
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -151,6 +212,17 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 #endif
 
 void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processBlockWithEngine(buffer, floatEngine);
+}
+
+void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processBlockWithEngine(buffer, doubleEngine);
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processBlockWithEngine(juce::AudioBuffer<SampleType>& buffer, EQEngine<SampleType>& engine)
 {
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
@@ -165,29 +237,93 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    updateFilters();
-
-    juce::dsp::AudioBlock<float> block(buffer);
+    const auto threadingMode = static_cast<ThreadingMode>(parameters[Param_Threading]);
+    engine.setUseWorkerPool(threadingMode == Threading_Always || (threadingMode == Threading_Offline && isNonRealtime()));
+    engine.setDeterministic(parameters[Param_Deterministic] > 0.5f);
 
     //OscilatorDEBUG for DEBUG || future use reference 2/3 blocks of code (use oscilatorDEBUG to find other references to oscilator code in the solution)
     //buffer.clear();
     //    juce::dsp::ProcessContextReplacing<float> stereocContext(block);
     //osc.process(stereocContext);
 
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
-    
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
-
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+    //a parameter change is picked up at the next control tick, where the block is split and the
+    //coefficients are redesigned once; while the smoothers glide, every tick designs for the value
+    //at the end of the tick and the engine ramps towards it. A block with nothing to update is
+    //rendered in one piece
+    const auto numSamples = buffer.getNumSamples();
+    const auto tickLength = controlRateTickLengths[(int)parameters[Param_ControlRate]];
+    controlScheduler.setTickLength(tickLength);
+
+    controlScheduler.processBlock(numSamples,
+        [this] { return parameterGeneration.load() != appliedParameterGeneration || smoothedSettings.isSmoothing() || morphPosition.isSmoothing(); },
+        [this, tickLength]
+        {
+            const auto generation = parameterGeneration.load();
+
+            if (generation != appliedParameterGeneration)
+            {
+                appliedParameterGeneration = generation;
+
+                //taken before the values are read: a preset is only published once all of its values are in
+                const auto* preset = pendingPreset.exchange(nullptr);
+
+                auto chainSettings = getChainSettings(parameters);
+                loadBandSettings(bandParameters, chainSettings.bands);
+
+                //a program change jumps straight to the preset: the smoothers don't glide, and the engine
+                //crossfades its cascades to the preset's stored sections instead of redesigning them
+                if (preset != nullptr)
+                {
+                    smoothedSettings.reset(getSampleRate(), chainSettings);
+                    updateFilters(chainSettings, tickLength, preset);
+                    return;
+                }
+
+                smoothedSettings.setTarget(chainSettings);
+                morphPosition.setTargetValue(parameters[Param_Morph]);
+            }
+
+            const auto& settings = smoothedSettings.advance(tickLength);
+            morphPosition.skip(tickLength);
+
+            //while morphing, the snapshots' own designs are blended and the live settings only supply the modes
+            if (parameters[Param_MorphEnabled] > 0.5f)
+            {
+                const auto& snapshots = snapshotMorph.acquire();
+                SnapshotMorph::Segment segment;
+
+                if (SnapshotMorph::findSegment(snapshots, morphPosition.getCurrentValue(), segment))
+                {
+                    updateFiltersMorphed(SnapshotMorph::getMorphedSettings(snapshots, segment, settings), snapshots, segment, tickLength);
+                    return;
+                }
+            }
+
+            updateFilters(settings, tickLength);
+        },
+        [&engine, &buffer, numSamples](int rangeStart, int rangeLength)
+        {
+            if (rangeLength == numSamples)
+            {
+                engine.process(buffer);
+                return;
+            }
+
+            juce::AudioBuffer<SampleType> subBlock(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), rangeStart, rangeLength);
+            engine.process(subBlock);
+        });
 
     leftChannelFifo.update(buffer);
     rightChannelFifo.update(buffer);
 
 }
 
+juce::AudioProcessorParameter* SimpleEQAudioProcessor::getBypassParameter() const
+{
+    //the host's bypass drives the same click-free fade as the transparent-settings fast path
+    return apvts.getParameter(getParameterID(Param_GlobalBypass));
+}
+
 //==============================================================================
 bool SimpleEQAudioProcessor::hasEditor() const
 {
@@ -207,144 +343,274 @@ void SimpleEQAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
     // You could do that either as raw data, or use the XML or ValueTree classes
     // as intermediaries to make it easy to save and load complex data.
 
-    juce::MemoryOutputStream mos(destData, true);
-    apvts.state.writeToStream(mos);
+    std::vector<StateSerialiser::Extension> extensions;
+    auto snapshots = writeSnapshots();
+
+    if (snapshots.getSize() > 0)
+        extensions.push_back({ snapshotsExtensionTag, std::move(snapshots) });
+
+    stateSerialiser.write(destData, extensions);
 }
 
 void SimpleEQAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
     // You should use this method to restore your parameters from this memory block,
     // whose contents will have been created by the getStateInformation() call.
+
+    if (stateSerialiser.read(data, sizeInBytes))
+    {
+        //a session saved without snapshots leaves none stored
+        juce::MemoryBlock snapshots;
+        StateSerialiser::findExtension(data, sizeInBytes, snapshotsExtensionTag, snapshots);
+        restoreSnapshots(snapshots);
+        return;
+    }
+
+    //sessions saved before the binary format hold the whole apvts ValueTree
     auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
     if (tree.isValid())
     {
+        //the parameter listeners pick the new values up on the audio thread
         apvts.replaceState(tree);
-        updateFilters();
+        restoreSnapshots({});
     }
 }
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
+juce::MemoryBlock SimpleEQAudioProcessor::writeSnapshots()
 {
-    ChainSettings settings;
+    //each stored snapshot as its index and a parameter block of its own
+    juce::MemoryBlock snapshots;
+    juce::MemoryOutputStream stream(snapshots, false);
+    const juce::ScopedLock lock(snapshotLock);
 
-    settings.lowCutFreq         =   apvts.getRawParameterValue("LowCut Freq")->load();
-    settings.highCutFreq        =   apvts.getRawParameterValue("HighCut Freq")->load();
-    settings.peakFreq           =   apvts.getRawParameterValue("Peak Freq")->load();
-    settings.peakGainInDecibels =   apvts.getRawParameterValue("Peak Gain")->load();
-    settings.peakQuality        =   apvts.getRawParameterValue("Peak Quality")->load();
-    settings.lowCutSlope        =   static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
-    settings.highCutSlope       =   static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
+    for (int index = 0; index < SnapshotMorph::maxSnapshots; ++index)
+    {
+        const auto& values = snapshotValues[(size_t)index];
+        if (values.empty())
+            continue;
 
-    settings.lowCutBypassed     =   apvts.getRawParameterValue("LowCut Bypass")->load() > 0.5f;
-    settings.highCutBypassed    =   apvts.getRawParameterValue("HighCut Bypass")->load() > 0.5f;
-    settings.peakBypassed       =   apvts.getRawParameterValue("Peak Bypass")->load() > 0.5f;
-    //settings.AnalyzerEnabled    =   apvts.getRawParameterValue("Analyzer Enabled")->load() > 0.5f;
+        juce::MemoryBlock block;
+        stateSerialiser.write(block, values);
 
+        stream.writeInt(index);
+        stream.writeInt((int)block.getSize());
+        stream.write(block.getData(), block.getSize());
+    }
 
-    return settings;
+    stream.flush();
+    return snapshots;
 }
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+void SimpleEQAudioProcessor::restoreSnapshots(const juce::MemoryBlock& extension)
 {
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-        chainSettings.peakFreq,
-        chainSettings.peakQuality,
-        juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
-}
+    const juce::ScopedLock lock(snapshotLock);
 
-void SimpleEQAudioProcessor::updatePeakFilter(const ChainSettings& chainSettings)
-{
-    //auto peakCoefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(),
-    //    chainSettings.peakFreq,
-    //    chainSettings.peakQuality,
-    //    juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+    for (auto& values : snapshotValues)
+        values.clear();
 
-    auto peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
+    snapshotMorph.clear();
 
-    leftChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
-    rightChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
+    juce::MemoryInputStream stream(extension, false);
 
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+    while (stream.getNumBytesRemaining() >= 8)
+    {
+        const auto index = stream.readInt();
+        const auto size = stream.readInt();
+
+        if (size < 0 || size > stream.getNumBytesRemaining())
+            break;
+
+        juce::MemoryBlock block((size_t)size);
+        stream.read(block.getData(), size);
+
+        if (!juce::isPositiveAndBelow(index, SnapshotMorph::maxSnapshots))
+            continue;
+
+        //parameters a snapshot doesn't hold, such as ones added since, take their defaults
+        std::vector<float> values;
+
+        for (int parameter = 0; parameter < stateSerialiser.getNumParameters(); ++parameter)
+            values.push_back(stateSerialiser.getParameter(parameter).getDefaultValue());
 
+        if (stateSerialiser.readValues(block.getData(), size, values))
+        {
+            snapshotMorph.store(index, getSnapshotSettings(values));
+            snapshotValues[(size_t)index] = std::move(values);
+        }
+    }
+
+    parameterGeneration.fetch_add(1);
 }
 
+bool SimpleEQAudioProcessor::getMorphedSections(EQSectionList<double>& sections, double sampleRate) const
+{
+    if (parameters[Param_MorphEnabled] <= 0.5f)
+        return false;
+
+    const juce::ScopedLock lock(snapshotLock);
+    const auto& snapshots = snapshotMorph.getStored();
+    SnapshotMorph::Segment segment;
 
-void updateCoefficients(Coefficients& old, const Coefficients& replacements)
+    if (!SnapshotMorph::findSegment(snapshots, parameters[Param_Morph], segment))
+        return false;
+
+    SnapshotMorph::designBlendedSections(sections, snapshots.settings[(size_t)segment.from], snapshots.settings[(size_t)segment.to],
+                                         segment.amount, sampleRate);
+    return true;
+}
+
+ChainSettings SimpleEQAudioProcessor::getSnapshotSettings(const std::vector<float>& normalisedValues) const
 {
-    *old = *replacements;
+    const auto getParameterValue = [this, &normalisedValues](juce::StringRef parameterID)
+    {
+        for (int index = 0; index < stateSerialiser.getNumParameters(); ++index)
+        {
+            const auto& parameter = stateSerialiser.getParameter(index);
 
+            if (parameter.getParameterID() == parameterID)
+                return parameter.convertFrom0to1(normalisedValues[(size_t)index]);
+        }
+
+        return 0.f;
+    };
+
+    auto settings = getChainSettings(getParameterValue);
+    loadBandSettings(getParameterValue, settings.bands);
+    return settings;
 }
 
+void SimpleEQAudioProcessor::updateFilters(const ChainSettings& chainSettings, int rampLengthInSamples, const PresetBank::Preset* preset)
+{
+    updateActiveEngine(chainSettings, [&](auto& engine, double sampleRate)
+    {
+        engine.updateFilters(chainSettings, sampleRate, rampLengthInSamples, preset);
+    });
+}
 
-void SimpleEQAudioProcessor::updateLowCutFilters(const ChainSettings& chainSettings)
+void SimpleEQAudioProcessor::updateFiltersMorphed(const ChainSettings& morphedSettings, const SnapshotMorph::Snapshots& snapshots,
+                                                  const SnapshotMorph::Segment& segment, int rampLengthInSamples)
 {
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
+    updateActiveEngine(morphedSettings, [&](auto& engine, double sampleRate)
+    {
+        engine.updateFiltersMorphed(morphedSettings, snapshots, segment, sampleRate, rampLengthInSamples);
+    });
+}
 
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
+template<typename Update>
+void SimpleEQAudioProcessor::updateActiveEngine(const ChainSettings& chainSettings, Update&& update)
+{
+    auto sampleRate = getSampleRate();
+    int tailLengthInSamples, engineLatency;
 
-    leftChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
-    rightChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
+    if (isUsingDoublePrecision())
+    {
+        update(doubleEngine, sampleRate);
+        tailLengthInSamples = doubleEngine.getTailLengthInSamples();
+        engineLatency = doubleEngine.getLatencyInSamples();
+    }
+    else
+    {
+        update(floatEngine, sampleRate);
+        tailLengthInSamples = floatEngine.getTailLengthInSamples();
+        engineLatency = floatEngine.getLatencyInSamples();
+    }
+
+    const auto latency = chainSettings.linearPhase && linearPhaseEQ.isEnabled() ? linearPhaseEQ.getLatencyInSamples() : engineLatency;
+
+    if (sampleRate > 0.0)
+        tailLengthSeconds.store(tailLengthInSamples / sampleRate);
 
-    updateCutFilter(leftLowCut, lowCutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(rightLowCut, lowCutCoefficients, chainSettings.lowCutSlope);
+    //the latency has to be reported, the worker threads started or stopped, the channels regrouped
+    //for the threading mode, and the linear-phase EQ enabled or disabled, from the message thread
+    if (latencyInSamples.exchange(latency) != latency
+        || getNumWorkersToUse() != workerPool.getNumWorkers()
+        || (static_cast<ThreadingMode>(parameters[Param_Threading]) != Threading_Off) != preparedForWorkerPool.load()
+        || chainSettings.linearPhase != linearPhaseEQ.isEnabled())
+        triggerAsyncUpdate();
 }
 
-void SimpleEQAudioProcessor::updateHighCutFilters(const ChainSettings& chainSettings)
+void SimpleEQAudioProcessor::storeSnapshot(int index)
 {
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
+    auto chainSettings = getChainSettings(parameters);
+    loadBandSettings(bandParameters, chainSettings.bands);
+
+    std::vector<float> values;
+
+    for (int parameter = 0; parameter < stateSerialiser.getNumParameters(); ++parameter)
+        values.push_back(stateSerialiser.getParameter(parameter).getValue());
 
-    auto& leftHighCut = leftChain.get<ChainPositions::HighCut>();
-    auto& rightHighCut = rightChain.get<ChainPositions::HighCut>();
+    {
+        const juce::ScopedLock lock(snapshotLock);
+        snapshotMorph.store(index, chainSettings);
+        snapshotValues[(size_t)index] = std::move(values);
+    }
 
-    leftChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
-    rightChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
+    //the audio thread picks the new snapshot up at the next control tick
+    parameterGeneration.fetch_add(1);
+}
 
-    updateCutFilter(leftHighCut, highCutCoefficients, chainSettings.highCutSlope);
-    updateCutFilter(rightHighCut, highCutCoefficients, chainSettings.highCutSlope);
+void SimpleEQAudioProcessor::clearSnapshots()
+{
+    restoreSnapshots({});
 }
 
-void SimpleEQAudioProcessor::updateFilters()
+void SimpleEQAudioProcessor::parameterValueChanged(int, float)
 {
-    auto chainSettings = getChainSettings(apvts);
-    updateLowCutFilters(chainSettings);
-    updateHighCutFilters(chainSettings);
-    updatePeakFilter(chainSettings);
+    //may arrive on any thread; the audio thread picks it up at the next control tick
+    parameterGeneration.fetch_add(1);
 }
 
-juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::createParameterLayout()
+int SimpleEQAudioProcessor::getNumWorkersToUse() const
 {
-    juce::AudioProcessorValueTreeState::ParameterLayout layout;
-    layout.add(std::make_unique<juce::AudioParameterFloat>("LowCut Freq",   "LowCut Freq",  juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20.f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("HighCut Freq",  "HighCut Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20000.f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Freq",     "Peak Freq",    juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 750.f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Gain",     "Peak Gain",    juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f), 0.0f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Quality",  "Peak Quality", juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f), 1.f));
-    
-    juce::StringArray stringArray;
-    for (int i = 0; i < 4; i++)
+    return static_cast<ThreadingMode>(parameters[Param_Threading]) != Threading_Off ? numUsefulWorkers.load() : 0;
+}
+
+void SimpleEQAudioProcessor::handleAsyncUpdate()
+{
+    if (presetBank.load() == nullptr)
     {
-        juce::String str;
-        str << (12 + i * 12);
-        str << " db/Oct";
-        stringArray.add(str);
+        if (const auto* bank = sharedPresetBank->load(stateSerialiser))
+        {
+            presetBank.store(bank);
+
+            //the host has only seen the placeholder program so far
+            updateHostDisplay();
+        }
     }
 
-    layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Slope",     "LowCut Slope",     stringArray, 0));
-    layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Slope",    "HighCut Slope",    stringArray, 0));
+    setLatencySamples(latencyInSamples.load());
 
-    layout.add(std::make_unique<juce::AudioParameterBool>("LowCut Bypass", "LowCut Bypass", false));
-    layout.add(std::make_unique<juce::AudioParameterBool>("HighCut Bypass", "HighCut Bypass", false));
-    layout.add(std::make_unique<juce::AudioParameterBool>("Peak Bypass", "Peak Bypass", false));
-    layout.add(std::make_unique<juce::AudioParameterBool>("Analyzer Enabled", "Analyzer Enabled", true));
+    const auto shouldUseWorkerPool = static_cast<ThreadingMode>(parameters[Param_Threading]) != Threading_Off;
 
+    //the channel groups are sized for the threading mode, so switching the pool on or off regroups
+    //them, which resets the filters
+    if (shouldUseWorkerPool != preparedForWorkerPool.load() && getSampleRate() > 0.0)
+    {
+        suspendProcessing(true);
+        prepareToPlay(getSampleRate(), getBlockSize());
+        suspendProcessing(false);
+    }
 
+    if (getNumWorkersToUse() != workerPool.getNumWorkers())
+        workerPool.start(getNumWorkersToUse());
 
-    return layout;
-}
+    const auto shouldUseLinearPhase = parameters[Param_LinearPhase] > 0.5f;
+
+    if (shouldUseLinearPhase != linearPhaseEQ.isEnabled())
+    {
+        linearPhaseEQ.setEnabled(shouldUseLinearPhase);
 
+        //the next control tick switches the engine over and reports the new latency
+        parameterGeneration.fetch_add(1);
+    }
+}
 
+juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::createParameterLayout()
+{
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+    addParameters(layout);
+    return layout;
+}
 
 //==============================================================================
 // This creates new instances of the plugin..
@@ -10,6 +10,15 @@
 
 #include <JuceHeader.h>
 #include <array>
+#include "ChainSettings.h"
+#include "ParameterRegistry.h"
+#include "LinearPhaseEQ.h"
+#include "EQEngine.h"
+#include "ControlRateScheduler.h"
+#include "SmoothedChainSettings.h"
+#include "StateSerialiser.h"
+#include "PresetBank.h"
+#include "SnapshotMorph.h"
 
 template<typename T>
 struct Fifo
@@ -87,15 +96,18 @@ struct SingleChannelSampleFifo
         prepared.set(false);
     }
 
-    void update(const BlockType& buffer)
+    template<typename SourceBlockType>
+    void update(const SourceBlockType& buffer)
     {
         jassert(prepared.get());
-        jassert(buffer.getNumChannels() > channelToUse);
-        auto* channelPtr = buffer.getReadPointer(channelToUse);
+        jassert(buffer.getNumChannels() > 0);
+
+        //a mono bus feeds both analyzer paths from its only channel
+        auto* channelPtr = buffer.getReadPointer(juce::jmin((int)channelToUse, buffer.getNumChannels() - 1));
 
         for (int i = 0; i < buffer.getNumSamples(); ++i)
         {
-            pushNextSampleIntoFifo(channelPtr[i]);
+            pushNextSampleIntoFifo(static_cast<float>(channelPtr[i]));
         }
     }
 
@@ -142,96 +154,12 @@ private:
     }
 };
 
-enum Slope
-{
-    Slope_12,
-    Slope_24,
-    Slope_36,
-    Slope_48
-};
-
-struct ChainSettings
-{
-    float       peakFreq{ 0 },              peakGainInDecibels{ 0 },   peakQuality{ 1.f };
-    float       lowCutFreq{ 0 },            highCutFreq{ 0 };
-    Slope       lowCutSlope{ Slope_12 },    highCutSlope{ Slope_12 };
-    bool        lowCutBypassed{ false },    peakBypassed{ false },
-                highCutBypassed{ false }/*,   AnalyzerEnabled{ true }*/;
-};
-
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
-
-using Filter = juce::dsp::IIR::Filter<float>;
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
-using Coefficients = Filter::CoefficientsPtr;
-
-enum ChainPositions
-{
-    LowCut,
-    Peak,
-    HighCut
-};
-
-void updateCoefficients(Coefficients& old, const Coefficients& replacements);
-
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
-
-
-template<int Index, typename ChainType, typename CoefficientType>
-void update(ChainType& chain, const CoefficientType& coefficients)
-{
-    updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]);
-    chain.template setBypassed<Index>(false);
-}
-
-template<typename ChainType, typename CoefficientType>
-void updateCutFilter(ChainType& chain, const CoefficientType& cutCoefficients, const Slope& slope)
-{
-    chain.template setBypassed<0>(true);
-    chain.template setBypassed<1>(true);
-    chain.template setBypassed<2>(true);
-    chain.template setBypassed<3>(true);
-
-    switch (slope)
-    {
-    case Slope_48:
-    {
-        update<3>(chain, cutCoefficients);
-    }
-    case Slope_36:
-    {
-        update<2>(chain, cutCoefficients);
-    }
-    case Slope_24:
-    {
-        update<1>(chain, cutCoefficients);
-    }
-    case Slope_12:
-    {
-        update<0>(chain, cutCoefficients);
-    }
-    }
-}
-
-inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq,
-        sampleRate,
-        2 * (chainSettings.lowCutSlope + 1));
-}
-
-inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq,
-        sampleRate,
-        2 * (chainSettings.highCutSlope + 1));
-}
-
 //========= =====================================================================
 /**
 */
-class SimpleEQAudioProcessor  : public juce::AudioProcessor
+class SimpleEQAudioProcessor  : public juce::AudioProcessor,
+                               private juce::AsyncUpdater,
+                               private juce::AudioProcessorParameter::Listener
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
@@ -250,6 +178,27 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    bool supportsDoublePrecisionProcessing() const override { return true; }
+
+    juce::AudioProcessorParameter* getBypassParameter() const override;
+
+    /** Stores the current settings as a morph snapshot, 0 being A and 1 being B. Message thread only. */
+    void storeSnapshot(int index);
+    void clearSnapshots();
+    int getNumSnapshots() const { return snapshotMorph.getNumStored(); }
+
+    /** The blend of the snapshots at the morph's position, designed at the rate, which is what the engine
+        runs while the morph is on. Returns false when it's off or fewer than two snapshots are stored.
+    */
+    bool getMorphedSections(EQSectionList<double>& sections, double sampleRate) const;
+
+    //the state extension the stored snapshots are saved in
+    static constexpr juce::uint32 snapshotsExtensionTag = 0x50414e53; // "SNAP"
+
+    /** What the control-rate ticks have cost since playback was last prepared. */
+    ControlRateScheduler::TickStats getControlTickStats() const { return controlScheduler.getTickStats(); }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -283,14 +232,75 @@ public:
     SingleChannelSampleFifo<BlockType> rightChannelFifo{ Channel::Right };
 
 private:
-    MonoChain leftChain, rightChain;
+    EQEngine<float> floatEngine;
+    EQEngine<double> doubleEngine;
+
+    LinearPhaseEQ linearPhaseEQ;
+
+    //of the linear-phase path or of the oversampling mode, whichever is in use
+    std::atomic<int> latencyInSamples{ 0 };
+
+    StateSerialiser stateSerialiser{ *this };
+
+    //loaded on the message thread after construction; until then the host sees a single unnamed program
+    juce::SharedResourcePointer<SharedPresetBank> sharedPresetBank;
+    std::atomic<const PresetBank*> presetBank{ nullptr };
+    std::atomic<int> currentProgram{ 0 };
+
+    //set by setCurrentProgram once the program's values are in, and taken by the control tick that picks them up
+    std::atomic<const PresetBank::Preset*> pendingPreset{ nullptr };
+
+    SnapshotMorph snapshotMorph;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> morphPosition;
+
+    //the normalised parameter values each snapshot was stored from, empty while it isn't stored, which is what
+    //a session saves. The lock is for hosts that save or restore off the message thread
+    std::array<std::vector<float>, SnapshotMorph::maxSnapshots> snapshotValues;
+    juce::CriticalSection snapshotLock;
+
+    juce::MemoryBlock writeSnapshots();
+
+    /** Replaces the snapshots with the ones in an extension written by writeSnapshots(), or clears them. */
+    void restoreSnapshots(const juce::MemoryBlock& extension);
+
+    ChainSettings getSnapshotSettings(const std::vector<float>& normalisedValues) const;
+
+    ChannelWorkerPool workerPool;
+    std::atomic<int> numUsefulWorkers{ 0 };
+    std::atomic<bool> preparedForWorkerPool{ false };
+
+    void handleAsyncUpdate() override;
+    int getNumWorkersToUse() const;
+
+    std::atomic<double> tailLengthSeconds{ 0.0 };
+
+    ParameterHandles parameters;
+    BandParameterTable bandParameters;
+
+    /** Updates the active engine, ramping its coefficients over the given number of samples.
+        With a preset, its stored sections are used where it has them for the rate.
+    */
+    void updateFilters(const ChainSettings& chainSettings, int rampLengthInSamples, const PresetBank::Preset* preset = nullptr);
+
+    /** Updates the active engine part way between two snapshots. */
+    void updateFiltersMorphed(const ChainSettings& morphedSettings, const SnapshotMorph::Snapshots& snapshots,
+                              const SnapshotMorph::Segment& segment, int rampLengthInSamples);
+
+    template<typename Update>
+    void updateActiveEngine(const ChainSettings& chainSettings, Update&& update);
+
+    //parameter reads and coefficient updates run on its ticks rather than once per host callback
+    ControlRateScheduler controlScheduler;
+    SmoothedChainSettings smoothedSettings;
+
+    std::atomic<juce::uint32> parameterGeneration{ 0 };
+    juce::uint32 appliedParameterGeneration = 0;
 
-    void updatePeakFilter(const ChainSettings& chainSettings);
-   
-    void updateLowCutFilters(const ChainSettings& chainSettings);
-    void updateHighCutFilters(const ChainSettings& chainSettings);
+    void parameterValueChanged(int parameterIndex, float newValue) override;
+    void parameterGestureChanged(int, bool) override {}
 
-    void updateFilters();
+    template<typename SampleType>
+    void processBlockWithEngine(juce::AudioBuffer<SampleType>& buffer, EQEngine<SampleType>& engine);
 
     //OscilatorDEBUG for DEBUG || future use reference 1/3 blocks of code (use oscilatorDEBUG to find other references to oscilator code in the solution)
     //juce::dsp::Oscillator<float> osc;
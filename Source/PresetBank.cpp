@@ -0,0 +1,264 @@
+/*
+  ==============================================================================
+
+    PresetBank.cpp
+
+  ==============================================================================
+*/
+
+#include "PresetBank.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+PresetBank::LoadResult PresetBank::load(const juce::File& file)
+{
+    presets.clear();
+    mappedFile.reset();
+
+    if (!file.existsAsFile())
+        return Load_Missing;
+
+    if (juce::ByteOrder::isBigEndian())
+        return Load_NotABank;
+
+    auto mapped = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+    const auto* data = static_cast<const char*>(mapped->getData());
+    const auto size = (juce::uint64)mapped->getSize();
+
+    if (data == nullptr || size < sizeof(FileHeader))
+        return Load_NotABank;
+
+    const auto& header = *reinterpret_cast<const FileHeader*>(data);
+
+    if (header.magic != magic)
+        return Load_NotABank;
+
+    //an older header ends before the revision, so the version has to be checked first
+    if (header.version != currentVersion || header.designRevision != designRevision)
+        return Load_OutOfDate;
+
+    if (header.headerSize < sizeof(FileHeader) || header.headerSize % 8 != 0 || header.presetSize % 8 != 0
+        || header.headerSize + (juce::uint64)header.numPresets * header.presetSize > size)
+        return Load_NotABank;
+
+    //sections from a build with a different slot layout can't be used, but the parameter blocks still can
+    const auto numSampleRates = header.numSections == MaxSections ? (int)header.numSampleRates : 0;
+    const auto sectionsOffset = (juce::uint64)nameSize + (juce::uint64)getPaddedStateSize((int)header.stateSize);
+
+    if (sectionsOffset + (juce::uint64)numSampleRates * sizeof(PresetSections) > header.presetSize)
+        return Load_NotABank;
+
+    presets.reserve(header.numPresets);
+
+    for (juce::uint32 index = 0; index < header.numPresets; ++index)
+    {
+        const auto* record = data + header.headerSize + (juce::uint64)index * header.presetSize;
+
+        Preset preset;
+        preset.name = juce::String::fromUTF8(record, (int)strnlen(record, (size_t)nameSize));
+        preset.state = record + nameSize;
+        preset.stateSize = (int)header.stateSize;
+        preset.sections = reinterpret_cast<const PresetSections*>(record + sectionsOffset);
+        preset.numSections = numSampleRates;
+
+        presets.push_back(preset);
+    }
+
+    mappedFile = std::move(mapped);
+    return Load_Succeeded;
+}
+
+const PresetBank::Preset* PresetBank::getPreset(int index) const
+{
+    return juce::isPositiveAndBelow(index, (int)presets.size()) ? &presets[(size_t)index] : nullptr;
+}
+
+std::vector<PresetBank::Definition> PresetBank::getFactoryPresets()
+{
+    const auto id = [](ParameterIndex index) { return juce::String(getParameterID(index)); };
+    const auto band = [](int bandIndex, BandParameter parameter) { return getBandParameterID(bandIndex, parameter); };
+
+    return {
+        { "Default", {} },
+        { "Vocal Presence", { { id(Param_LowCutFreq), 90.f }, { id(Param_LowCutSlope), Slope_24 },
+                              { id(Param_PeakFreq), 3000.f }, { id(Param_PeakGain), 3.f }, { id(Param_PeakQuality), 0.8f },
+                              { band(0, BandEnabled), 1.f }, { band(0, BandTypeChoice), Band_HighShelf },
+                              { band(0, BandFreq), 10000.f }, { band(0, BandGain), 2.f }, { band(0, BandQuality), 0.7f } } },
+        { "Kick Tighten",   { { id(Param_LowCutFreq), 30.f }, { id(Param_LowCutSlope), Slope_48 },
+                              { id(Param_PeakFreq), 350.f }, { id(Param_PeakGain), -4.f }, { id(Param_PeakQuality), 1.4f },
+                              { band(0, BandEnabled), 1.f }, { band(0, BandFreq), 60.f }, { band(0, BandGain), 3.f } } },
+        { "De-Mud",         { { id(Param_PeakFreq), 300.f }, { id(Param_PeakGain), -3.f }, { id(Param_PeakQuality), 1.2f },
+                              { band(0, BandEnabled), 1.f }, { band(0, BandTypeChoice), Band_LowShelf },
+                              { band(0, BandFreq), 100.f }, { band(0, BandGain), -2.f }, { band(0, BandQuality), 0.7f } } },
+        { "Air",            { { band(0, BandEnabled), 1.f }, { band(0, BandTypeChoice), Band_HighShelf },
+                              { band(0, BandFreq), 12000.f }, { band(0, BandGain), 4.f }, { band(0, BandQuality), 0.7f } } },
+        { "Telephone",      { { id(Param_LowCutFreq), 400.f }, { id(Param_LowCutSlope), Slope_48 },
+                              { id(Param_HighCutFreq), 3400.f }, { id(Param_HighCutSlope), Slope_48 },
+                              { id(Param_PeakFreq), 1500.f }, { id(Param_PeakGain), 4.f }, { id(Param_PeakQuality), 0.7f } } },
+        { "Gentle Master",  { { id(Param_LowCutFreq), 25.f }, { id(Param_LowCutSlope), Slope_24 }, { id(Param_MatchedResponse), 1.f },
+                              { band(0, BandEnabled), 1.f }, { band(0, BandTypeChoice), Band_LowShelf },
+                              { band(0, BandFreq), 80.f }, { band(0, BandGain), 1.5f }, { band(0, BandQuality), 0.7f },
+                              { band(1, BandEnabled), 1.f }, { band(1, BandTypeChoice), Band_HighShelf },
+                              { band(1, BandFreq), 12000.f }, { band(1, BandGain), 1.5f }, { band(1, BandQuality), 0.7f } } }
+    };
+}
+
+bool PresetBank::writeFile(const juce::File& file, const std::vector<Definition>& definitions, const StateSerialiser& serialiser)
+{
+    const auto numParameters = serialiser.getNumParameters();
+
+    const auto findParameter = [&serialiser, numParameters](juce::StringRef parameterID)
+    {
+        for (int index = 0; index < numParameters; ++index)
+        {
+            if (serialiser.getParameter(index).getParameterID() == parameterID)
+                return index;
+        }
+
+        return -1;
+    };
+
+    //the entries a preset block holds, the same for every preset so the blocks share a size
+    std::vector<int> presetParameters;
+
+    for (const auto& info : parameterTable)
+    {
+        if (isPresetParameter(info.index))
+            presetParameters.push_back(findParameter(info.id));
+    }
+
+    for (int bandIndex = 0; bandIndex < MaxBands; ++bandIndex)
+    {
+        for (int parameter = 0; parameter < NumBandParameters; ++parameter)
+            presetParameters.push_back(findParameter(getBandParameterID(bandIndex, (BandParameter)parameter)));
+    }
+
+    jassert(std::find(presetParameters.begin(), presetParameters.end(), -1) == presetParameters.end());
+    presetParameters.erase(std::remove(presetParameters.begin(), presetParameters.end(), -1), presetParameters.end());
+
+    std::vector<juce::MemoryBlock> states;
+    std::vector<ChainSettings> settings;
+
+    for (const auto& definition : definitions)
+    {
+        //every parameter starts from its default, and the definition moves the ones it names
+        std::vector<float> values;
+
+        for (int index = 0; index < numParameters; ++index)
+            values.push_back(serialiser.getParameter(index).getDefaultValue());
+
+        for (const auto& [parameterID, value] : definition.values)
+        {
+            const auto index = findParameter(parameterID);
+            jassert(index >= 0);
+
+            if (index >= 0)
+                values[(size_t)index] = serialiser.getParameter(index).convertTo0to1(value);
+        }
+
+        states.emplace_back();
+        serialiser.write(states.back(), values, presetParameters);
+
+        const auto getParameterValue = [&](juce::StringRef parameterID)
+        {
+            const auto index = findParameter(parameterID);
+            return index >= 0 ? serialiser.getParameter(index).convertFrom0to1(values[(size_t)index]) : 0.f;
+        };
+
+        settings.push_back(getChainSettings(getParameterValue));
+        loadBandSettings(getParameterValue, settings.back().bands);
+    }
+
+    const auto stateSize = states.empty() ? 0 : (int)states.front().getSize();
+    const auto paddedStateSize = getPaddedStateSize(stateSize);
+
+    FileHeader header{};
+    header.magic = magic;
+    header.version = (juce::uint16)currentVersion;
+    header.headerSize = (juce::uint16)sizeof(FileHeader);
+    header.numPresets = (juce::uint32)definitions.size();
+    header.presetSize = (juce::uint32)(nameSize + paddedStateSize + sampleRates.size() * sizeof(PresetSections));
+    header.numSampleRates = (juce::uint16)sampleRates.size();
+    header.numSections = (juce::uint16)MaxSections;
+    header.stateSize = (juce::uint32)stateSize;
+    header.designRevision = designRevision;
+
+    juce::MemoryBlock bank;
+    juce::MemoryOutputStream stream(bank, false);
+    stream.write(&header, sizeof(header));
+
+    for (size_t index = 0; index < definitions.size(); ++index)
+    {
+        char name[nameSize]{};
+        std::strncpy(name, definitions[index].name.toRawUTF8(), (size_t)nameSize - 1);
+        stream.write(name, sizeof(name));
+
+        const char padding[8]{};
+        stream.write(states[index].getData(), states[index].getSize());
+        stream.write(padding, (size_t)(paddedStateSize - (int)states[index].getSize()));
+
+        for (auto sampleRate : sampleRates)
+        {
+            EQSectionList<double> sections;
+            makeSectionList(sections, settings[index], sampleRate);
+
+            PresetSections record{};
+            record.sampleRate = sampleRate;
+
+            for (int slot = 0; slot < MaxSections; ++slot)
+            {
+                if (!sections.active[slot])
+                    continue;
+
+                const auto& c = sections.coefficients[slot];
+                record.activeSlots |= juce::uint64(1) << slot;
+                record.coefficients[slot][0] = c.b0;
+                record.coefficients[slot][1] = c.b1;
+                record.coefficients[slot][2] = c.b2;
+                record.coefficients[slot][3] = c.a1;
+                record.coefficients[slot][4] = c.a2;
+            }
+
+            stream.write(&record, sizeof(record));
+        }
+    }
+
+    stream.flush();
+
+    if (!file.getParentDirectory().createDirectory())
+        return false;
+
+    juce::TemporaryFile temporaryFile(file);
+
+    return temporaryFile.getFile().replaceWithData(bank.getData(), bank.getSize())
+        && temporaryFile.overwriteTargetFileWithTemporary();
+}
+
+//==============================================================================
+const PresetBank* SharedPresetBank::load(const StateSerialiser& serialiser)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    if (!std::exchange(attempted, true))
+    {
+        const auto file = PresetBank::getDefaultFile();
+        const auto result = bank.load(file);
+
+        //the factory bank is written out the first time, and again over a bank whose stored sections were
+        //designed by an older build; any other file is left to whoever replaced it
+        if ((result == PresetBank::Load_Missing || result == PresetBank::Load_OutOfDate)
+            && PresetBank::writeFile(file, PresetBank::getFactoryPresets(), serialiser))
+            loaded = bank.load(file) == PresetBank::Load_Succeeded;
+        else
+            loaded = result == PresetBank::Load_Succeeded;
+    }
+
+    return loaded ? &bank : nullptr;
+}
+
+juce::File PresetBank::getDefaultFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile(JucePlugin_Name).getChildFile("Presets.seqbank");
+}
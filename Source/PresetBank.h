@@ -0,0 +1,165 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+    The programs the host sees, read from a bank file that is memory-mapped
+    rather than parsed. Each preset holds the values of the parameters that
+    shape the EQ as a StateSerialiser block, followed by its biquad sections
+    already designed at the common sample rates. Switching programs hands the audio thread a
+    pointer into the mapping, and the engine ramps its cascades to the
+    stored sections instead of redesigning them.
+
+    The file is written in native byte order, little-endian on every
+    platform the plugin is built for, and laid out so every record is
+    8-byte aligned and can be read in place:
+
+        FileHeader
+        numPresets x { name, parameter block, numSampleRates x PresetSections }
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <memory>
+#include <vector>
+#include "ParameterRegistry.h"
+#include "StateSerialiser.h"
+
+class PresetBank
+{
+public:
+    static constexpr juce::uint32 magic = 0x4b514553; // "SEQK"
+    //3 stores only the parameters that shape the EQ, so applying a preset leaves the session's modes alone
+    static constexpr int currentVersion = 3;
+
+    //bumped whenever the section designs change, so banks holding sections designed the old way get rewritten
+    static constexpr juce::uint32 designRevision = 1;
+
+    static constexpr int nameSize = 64;
+
+    //the rates the factory bank stores sections for, which include 2x and 4x oversampled 44.1 and 48kHz
+    static constexpr std::array<double, 6> sampleRates{ 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+
+    struct FileHeader
+    {
+        juce::uint32 magic;
+        juce::uint16 version, headerSize;
+        juce::uint32 numPresets, presetSize;
+        juce::uint16 numSampleRates, numSections;
+        juce::uint32 stateSize;
+        juce::uint32 designRevision, padding;
+    };
+
+    /** One preset's biquads at one sample rate, bit i of activeSlots marking slot i in use. */
+    struct PresetSections
+    {
+        double sampleRate;
+        juce::uint64 activeSlots;
+        double coefficients[MaxSections][5];
+
+        BiquadCoefficients<double> getBiquad(int slot) const
+        {
+            const auto* c = coefficients[slot];
+            return { c[0], c[1], c[2], c[3], c[4] };
+        }
+
+        /** Fills a list of either topology at the engine's precision. Cheap enough for the audio thread. */
+        template<typename CoefficientType>
+        void loadInto(SectionList<CoefficientType, MaxSections>& sections) const
+        {
+            for (int slot = 0; slot < MaxSections; ++slot)
+            {
+                sections.active[slot] = ((activeSlots >> slot) & 1) != 0;
+
+                if (sections.active[slot])
+                    convertSection(getBiquad(slot), sections.coefficients[slot]);
+            }
+        }
+    };
+
+    static_assert(sizeof(FileHeader) % 8 == 0 && sizeof(PresetSections) % 8 == 0, "bank records must keep 8-byte alignment");
+    static_assert(MaxSections <= 64, "the active slots of a preset are stored as a 64-bit mask");
+
+    /** A preset in the mapped file. Stays valid for as long as the bank is loaded. */
+    struct Preset
+    {
+        juce::String name;
+        const void* state = nullptr;
+        int stateSize = 0;
+        const PresetSections* sections = nullptr;
+        int numSections = 0;
+
+        /** The stored sections for exactly this rate, or nullptr when the preset has to be designed. */
+        const PresetSections* findSections(double sampleRate) const
+        {
+            for (int index = 0; index < numSections; ++index)
+            {
+                if (sections[index].sampleRate == sampleRate)
+                    return sections + index;
+            }
+
+            return nullptr;
+        }
+    };
+
+    /** A preset to write: its name and the plain values of the parameters it moves from their defaults. */
+    struct Definition
+    {
+        juce::String name;
+        std::vector<std::pair<juce::String, float>> values;
+    };
+
+    enum LoadResult
+    {
+        Load_Succeeded,
+        Load_Missing,
+        Load_OutOfDate,
+        Load_NotABank
+    };
+
+    /** Maps the file and indexes its presets. Leaves the bank empty unless it returns Load_Succeeded,
+        which it only does for a bank of this version and design revision.
+    */
+    LoadResult load(const juce::File& file);
+
+    int getNumPresets() const { return (int)presets.size(); }
+
+    /** nullptr when the index is out of range. */
+    const Preset* getPreset(int index) const;
+
+    static std::vector<Definition> getFactoryPresets();
+
+    /** Writes a bank of the definitions, designing each preset's sections at every rate in sampleRates.
+        The file is replaced in one move, so a reader never sees it half written.
+    */
+    static bool writeFile(const juce::File& file, const std::vector<Definition>& definitions, const StateSerialiser& serialiser);
+
+    /** Where the bank is looked for, and where the factory bank is written when there isn't one yet. */
+    static juce::File getDefaultFile();
+
+private:
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    std::vector<Preset> presets;
+
+    static int getPaddedStateSize(int stateSize) { return (stateSize + 7) & ~7; }
+};
+
+//==============================================================================
+/** The bank every instance in the process shares, held through a juce::SharedResourcePointer.
+    It is loaded, and written first when it is missing or out of date, once and on the message
+    thread, so no host thread waits on the disk and no instance writes over a bank another one
+    has mapped.
+*/
+class SharedPresetBank
+{
+public:
+    /** Message thread only. Loads the bank the first time it's called, and returns it once it has loaded. */
+    const PresetBank* load(const StateSerialiser& serialiser);
+
+private:
+    PresetBank bank;
+    bool attempted = false, loaded = false;
+};
@@ -0,0 +1,210 @@
+/*
+  ==============================================================================
+
+    SVFCascade.h
+    The trapezoidal (TPT) state-variable filter as a section topology for the
+    cascade. A section is described by its prewarped cutoff g, damping k and
+    the mix of the high/band/low-pass outputs, so a design is a single tan
+    plus a few multiplies, and the filter stays stable for any positive g and
+    k, which makes fast modulation safe. Being bilinear with prewarping at the
+    cutoff, the peak, shelf and Butterworth cut designs below have exactly the
+    same response as the RBJ and FilterDesign ones used by the biquad engine.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadCascade.h"
+
+template<typename SampleType>
+struct SVFCoefficients
+{
+    //design parameters, which are what a ramp interpolates
+    SampleType g{ 0 }, k{ 2 }, m0{ 1 }, m1{ 0 }, m2{ 0 };
+
+    //derived per-sample gains
+    SampleType a1{ 1 }, a2{ 0 }, a3{ 0 };
+
+    void updateGains()
+    {
+        a1 = SampleType(1) / (SampleType(1) + g * (g + k));
+        a2 = g * a1;
+        a3 = g * a2;
+    }
+
+    /** The equivalent normalised biquad, for response curves and decay estimates. */
+    BiquadCoefficients<SampleType> toBiquad() const
+    {
+        const auto gg = g * g;
+        const auto d0 = SampleType(1) + g * k + gg;
+        const auto d1 = SampleType(2) * (gg - SampleType(1));
+        const auto d2 = SampleType(1) - g * k + gg;
+
+        return { (m0 * d0 + m1 * g + m2 * gg) / d0,
+                 (m0 * d1 + SampleType(2) * m2 * gg) / d0,
+                 (m0 * d2 - m1 * g + m2 * gg) / d0,
+                 d1 / d0,
+                 d2 / d0 };
+    }
+
+    double getMagnitudeForFrequency(double frequency, double sampleRate) const
+    {
+        return toBiquad().getMagnitudeForFrequency(frequency, sampleRate);
+    }
+};
+
+//==============================================================================
+namespace SVFDesign
+{
+    template<typename SampleType>
+    SampleType prewarp(double frequency, double sampleRate)
+    {
+        //keep the design below nyquist when the host runs at a low sample rate
+        const auto freq = juce::jmin(frequency, sampleRate * 0.49);
+        return static_cast<SampleType>(std::tan(juce::MathConstants<double>::pi * freq / sampleRate));
+    }
+
+    template<typename SampleType>
+    SVFCoefficients<SampleType> make(SampleType g, SampleType k, SampleType m0, SampleType m1, SampleType m2)
+    {
+        SVFCoefficients<SampleType> c;
+        c.g = g;
+        c.k = k;
+        c.m0 = m0;
+        c.m1 = m1;
+        c.m2 = m2;
+        c.updateGains();
+        return c;
+    }
+
+    template<typename SampleType>
+    SVFCoefficients<SampleType> makeLowPass(double sampleRate, double frequency, SampleType q)
+    {
+        return make(prewarp<SampleType>(frequency, sampleRate), SampleType(1) / q, SampleType(0), SampleType(0), SampleType(1));
+    }
+
+    template<typename SampleType>
+    SVFCoefficients<SampleType> makeHighPass(double sampleRate, double frequency, SampleType q)
+    {
+        const auto k = SampleType(1) / q;
+        return make(prewarp<SampleType>(frequency, sampleRate), k, SampleType(1), -k, SampleType(-1));
+    }
+
+    template<typename SampleType>
+    SVFCoefficients<SampleType> makePeakFilter(double sampleRate, double frequency, SampleType q, SampleType gainFactor)
+    {
+        const auto A = std::sqrt(gainFactor);
+        const auto k = SampleType(1) / (q * A);
+        return make(prewarp<SampleType>(frequency, sampleRate), k, SampleType(1), k * (A * A - SampleType(1)), SampleType(0));
+    }
+
+    template<typename SampleType>
+    SVFCoefficients<SampleType> makeLowShelf(double sampleRate, double frequency, SampleType q, SampleType gainFactor)
+    {
+        const auto A = std::sqrt(gainFactor);
+        const auto k = SampleType(1) / q;
+        return make(prewarp<SampleType>(frequency, sampleRate) / std::sqrt(A), k, SampleType(1), k * (A - SampleType(1)), A * A - SampleType(1));
+    }
+
+    template<typename SampleType>
+    SVFCoefficients<SampleType> makeHighShelf(double sampleRate, double frequency, SampleType q, SampleType gainFactor)
+    {
+        const auto A = std::sqrt(gainFactor);
+        const auto k = SampleType(1) / q;
+        return make(prewarp<SampleType>(frequency, sampleRate) * std::sqrt(A), k, A * A, k * (SampleType(1) - A) * A, SampleType(1) - A * A);
+    }
+
+    /** The SVF with the same response as a stable normalised biquad, for designs that are
+        made in the z domain. Inverts the mapping in SVFCoefficients::toBiquad().
+    */
+    template<typename SampleType>
+    SVFCoefficients<SampleType> fromBiquad(const BiquadCoefficients<double>& c)
+    {
+        const auto d0 = 4.0 / (1.0 - c.a1 + c.a2);
+        const auto g = std::sqrt((1.0 + c.a1 + c.a2) / (1.0 - c.a1 + c.a2));
+        const auto k = (1.0 - c.a2) * d0 / (2.0 * g);
+
+        const auto n0 = c.b0 * d0, n1 = c.b1 * d0, n2 = c.b2 * d0;
+        const auto m0 = 0.25 * (n0 - n1 + n2);
+        const auto m1 = (n0 - n2) / (2.0 * g) - m0 * k;
+        const auto m2 = (n1 - 2.0 * m0 * (g * g - 1.0)) / (2.0 * g * g);
+
+        return make(static_cast<SampleType>(g), static_cast<SampleType>(k),
+                    static_cast<SampleType>(m0), static_cast<SampleType>(m1), static_cast<SampleType>(m2));
+    }
+
+    /** Q of each second-order stage of an even-order Butterworth filter, as FilterDesign splits it. */
+    template<typename SampleType>
+    SampleType getButterworthQ(int stage, int order)
+    {
+        return static_cast<SampleType>(1.0 / (2.0 * std::cos((2.0 * stage + 1.0) * juce::MathConstants<double>::pi / (2.0 * order))));
+    }
+}
+
+//==============================================================================
+/** Andrew Simper's linear trapezoidal SVF, with the two integrator states kept per lane. */
+template<typename SampleType>
+struct TrapezoidalSVF
+{
+    using Coefficients = SVFCoefficients<SampleType>;
+
+    //a lone channel runs through processFrame like any other
+    static constexpr bool hasBlockKernel = false;
+    static constexpr int blockLength = 1;
+    struct BlockKernel {};
+
+    static Coefficients makeStep(const Coefficients& from, const Coefficients& to, SampleType scale)
+    {
+        Coefficients step;
+        step.g = (to.g - from.g) * scale;
+        step.k = (to.k - from.k) * scale;
+        step.m0 = (to.m0 - from.m0) * scale;
+        step.m1 = (to.m1 - from.m1) * scale;
+        step.m2 = (to.m2 - from.m2) * scale;
+        return step;
+    }
+
+    /** Any positive g and k is a stable filter, so the ramp can move them freely. */
+    static void advance(Coefficients& c, const Coefficients& step)
+    {
+        c.g += step.g;
+        c.k += step.k;
+        c.m0 += step.m0;
+        c.m1 += step.m1;
+        c.m2 += step.m2;
+        c.updateGains();
+    }
+
+    //the frames are compiled with the rest of the engine, in the build's vectors
+    static int getVectorSize() { return (int)juce::dsp::SIMDRegister<SampleType>::SIMDNumElements; }
+
+    static void processFrame(SampleType* frame, SampleType* ic1eq, SampleType* ic2eq, int lanes, const Coefficients& c)
+    {
+        const auto a1 = c.a1, a2 = c.a2, a3 = c.a3, m0 = c.m0, m1 = c.m1, m2 = c.m2;
+
+        //one channel per lane
+        for (int lane = 0; lane < lanes; ++lane)
+        {
+            const auto v0 = frame[lane];
+            const auto v3 = v0 - ic2eq[lane];
+            const auto v1 = a1 * ic1eq[lane] + a2 * v3;
+            const auto v2 = ic2eq[lane] + a2 * ic1eq[lane] + a3 * v3;
+            ic1eq[lane] = SampleType(2) * v1 - ic1eq[lane];
+            ic2eq[lane] = SampleType(2) * v2 - ic2eq[lane];
+            frame[lane] = m0 * v0 + m1 * v1 + m2 * v2;
+        }
+    }
+
+    //the loop is compiled with the rest of the engine, so it is already the same on every CPU
+    static void processFrames(SampleType* frames, SampleType* ic1eq, SampleType* ic2eq, int lanes, int numFrames, const Coefficients& c,
+                              bool /*deterministic*/ = false)
+    {
+        for (int i = 0; i < numFrames; ++i)
+            processFrame(frames + i * lanes, ic1eq, ic2eq, lanes, c);
+    }
+};
+
+template<typename SampleType, int NumSlots>
+using SVFCascade = SectionCascade<SampleType, NumSlots, TrapezoidalSVF<SampleType>>;
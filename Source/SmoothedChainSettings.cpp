@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+    SmoothedChainSettings.cpp
+
+  ==============================================================================
+*/
+
+#include "SmoothedChainSettings.h"
+
+void SmoothedChainSettings::reset(double sampleRate, const ChainSettings& settings)
+{
+    current = settings;
+
+    lowCutFreq.reset(sampleRate, rampLengthInSeconds);
+    highCutFreq.reset(sampleRate, rampLengthInSeconds);
+    peakFreq.reset(sampleRate, rampLengthInSeconds);
+    peakQuality.reset(sampleRate, rampLengthInSeconds);
+    peakGainInDecibels.reset(sampleRate, rampLengthInSeconds);
+
+    lowCutFreq.setCurrentAndTargetValue(settings.lowCutFreq);
+    highCutFreq.setCurrentAndTargetValue(settings.highCutFreq);
+    peakFreq.setCurrentAndTargetValue(settings.peakFreq);
+    peakQuality.setCurrentAndTargetValue(settings.peakQuality);
+    peakGainInDecibels.setCurrentAndTargetValue(settings.peakGainInDecibels);
+
+    for (size_t band = 0; band < bands.size(); ++band)
+    {
+        auto& smoothers = bands[band];
+        const auto& values = settings.bands[band];
+
+        smoothers.freq.reset(sampleRate, rampLengthInSeconds);
+        smoothers.quality.reset(sampleRate, rampLengthInSeconds);
+        smoothers.gainInDecibels.reset(sampleRate, rampLengthInSeconds);
+
+        smoothers.freq.setCurrentAndTargetValue(values.freq);
+        smoothers.quality.setCurrentAndTargetValue(values.quality);
+        smoothers.gainInDecibels.setCurrentAndTargetValue(values.gainInDecibels);
+    }
+}
+
+void SmoothedChainSettings::setTarget(const ChainSettings& target)
+{
+    //a band that was silent or shaped differently has nothing sensible to glide from
+    for (size_t band = 0; band < bands.size(); ++band)
+    {
+        auto& smoothers = bands[band];
+        const auto& values = target.bands[band];
+        const auto& previous = current.bands[band];
+
+        if (values.enabled && (!previous.enabled || values.type != previous.type))
+        {
+            smoothers.freq.setCurrentAndTargetValue(values.freq);
+            smoothers.quality.setCurrentAndTargetValue(values.quality);
+            smoothers.gainInDecibels.setCurrentAndTargetValue(values.gainInDecibels);
+        }
+        else
+        {
+            smoothers.freq.setTargetValue(values.freq);
+            smoothers.quality.setTargetValue(values.quality);
+            smoothers.gainInDecibels.setTargetValue(values.gainInDecibels);
+        }
+    }
+
+    //everything that isn't smoothed is taken as is, then the smoothed fields are put back in advance()
+    current = target;
+
+    lowCutFreq.setTargetValue(target.lowCutFreq);
+    highCutFreq.setTargetValue(target.highCutFreq);
+    peakFreq.setTargetValue(target.peakFreq);
+    peakQuality.setTargetValue(target.peakQuality);
+    peakGainInDecibels.setTargetValue(target.peakGainInDecibels);
+
+    current.lowCutFreq = lowCutFreq.getCurrentValue();
+    current.highCutFreq = highCutFreq.getCurrentValue();
+    current.peakFreq = peakFreq.getCurrentValue();
+    current.peakQuality = peakQuality.getCurrentValue();
+    current.peakGainInDecibels = peakGainInDecibels.getCurrentValue();
+
+    for (size_t band = 0; band < bands.size(); ++band)
+    {
+        current.bands[band].freq = bands[band].freq.getCurrentValue();
+        current.bands[band].quality = bands[band].quality.getCurrentValue();
+        current.bands[band].gainInDecibels = bands[band].gainInDecibels.getCurrentValue();
+    }
+}
+
+bool SmoothedChainSettings::isSmoothing() const
+{
+    if (lowCutFreq.isSmoothing() || highCutFreq.isSmoothing() || peakFreq.isSmoothing()
+        || peakQuality.isSmoothing() || peakGainInDecibels.isSmoothing())
+        return true;
+
+    for (const auto& smoothers : bands)
+    {
+        if (smoothers.freq.isSmoothing() || smoothers.quality.isSmoothing() || smoothers.gainInDecibels.isSmoothing())
+            return true;
+    }
+
+    return false;
+}
+
+const ChainSettings& SmoothedChainSettings::advance(int numSamples)
+{
+    current.lowCutFreq = lowCutFreq.skip(numSamples);
+    current.highCutFreq = highCutFreq.skip(numSamples);
+    current.peakFreq = peakFreq.skip(numSamples);
+    current.peakQuality = peakQuality.skip(numSamples);
+    current.peakGainInDecibels = peakGainInDecibels.skip(numSamples);
+
+    for (size_t band = 0; band < bands.size(); ++band)
+    {
+        current.bands[band].freq = bands[band].freq.skip(numSamples);
+        current.bands[band].quality = bands[band].quality.skip(numSamples);
+        current.bands[band].gainInDecibels = bands[band].gainInDecibels.skip(numSamples);
+    }
+
+    return current;
+}
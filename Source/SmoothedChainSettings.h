@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    SmoothedChainSettings.h
+    Per-parameter smoothing for the continuous controls of the fixed chain
+    and of every parametric band.
+    It is advanced once per control tick, and the engine ramps its
+    coefficients linearly across the tick, so a knob move or automation costs
+    one design per tick rather than a jump at a block boundary or a redesign
+    every sample.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+
+class SmoothedChainSettings
+{
+public:
+    static constexpr double rampLengthInSeconds = 0.05;
+
+    /** Jumps straight to the given settings. */
+    void reset(double sampleRate, const ChainSettings& settings);
+
+    /** Sets the values to glide towards. Switches, slopes and band types take effect immediately, and a
+        band that has just been switched on or changed type jumps to its new values.
+    */
+    void setTarget(const ChainSettings& target);
+
+    bool isSmoothing() const;
+
+    /** Moves every smoother on by numSamples and returns the settings to design for. */
+    const ChainSettings& advance(int numSamples);
+
+private:
+    ChainSettings current;
+
+    //frequencies and Q glide in equal ratios, gain in equal dB steps
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> lowCutFreq, highCutFreq, peakFreq, peakQuality;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> peakGainInDecibels;
+
+    struct BandSmoothers
+    {
+        juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> freq, quality;
+        juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> gainInDecibels;
+    };
+
+    std::array<BandSmoothers, MaxBands> bands;
+};
@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    SnapshotMorph.cpp
+
+  ==============================================================================
+*/
+
+#include "SnapshotMorph.h"
+#include <algorithm>
+
+int SnapshotMorph::Snapshots::getNumStored() const
+{
+    return (int)std::count(stored.begin(), stored.end(), true);
+}
+
+void SnapshotMorph::store(int index, const ChainSettings& settings)
+{
+    jassert(juce::isPositiveAndBelow(index, maxSnapshots));
+
+    master.settings[(size_t)index] = settings;
+    master.stored[(size_t)index] = true;
+    publish();
+}
+
+void SnapshotMorph::clear()
+{
+    master.stored.fill(false);
+    publish();
+}
+
+void SnapshotMorph::publish()
+{
+    ++master.generation;
+
+    const auto current = published.load();
+    const auto inUse = reading.load();
+
+    int free = 0;
+    while (free == current || free == inUse)
+        ++free;
+
+    copies[(size_t)free] = master;
+    published.store(free);
+}
+
+const SnapshotMorph::Snapshots& SnapshotMorph::acquire()
+{
+    //announce the copy before trusting it: once it is still the published one after that, no store will pick it
+    int index;
+
+    do
+    {
+        index = published.load();
+        reading.store(index);
+    }
+    while (index != published.load());
+
+    return copies[(size_t)index];
+}
+
+bool SnapshotMorph::findSegment(const Snapshots& snapshots, float position, Segment& segment)
+{
+    std::array<int, maxSnapshots> order;
+    int numStored = 0;
+
+    for (int index = 0; index < maxSnapshots; ++index)
+    {
+        if (snapshots.stored[(size_t)index])
+            order[(size_t)numStored++] = index;
+    }
+
+    if (numStored < 2)
+        return false;
+
+    const auto scaled = juce::jlimit(0.f, 1.f, position) * (float)(numStored - 1);
+    const auto first = juce::jmin((int)scaled, numStored - 2);
+
+    segment.from = order[(size_t)first];
+    segment.to = order[(size_t)first + 1];
+    segment.amount = scaled - (float)first;
+    return true;
+}
+
+ChainSettings SnapshotMorph::getMorphedSettings(const Snapshots& snapshots, const Segment& segment, const ChainSettings& live)
+{
+    const auto& a = snapshots.settings[(size_t)segment.from];
+    const auto& b = snapshots.settings[(size_t)segment.to];
+    const auto t = segment.amount;
+
+    const auto linear = [t](float from, float to) { return from + t * (to - from); };
+    const auto ratio = [t](float from, float to) { return from * std::pow(to / from, t); };
+
+    auto settings = t < 0.5f ? a : b;
+
+    settings.lowCutFreq = ratio(a.lowCutFreq, b.lowCutFreq);
+    settings.highCutFreq = ratio(a.highCutFreq, b.highCutFreq);
+    settings.peakFreq = ratio(a.peakFreq, b.peakFreq);
+    settings.peakQuality = ratio(a.peakQuality, b.peakQuality);
+    settings.peakGainInDecibels = linear(a.peakGainInDecibels, b.peakGainInDecibels);
+
+    for (int band = 0; band < MaxBands; ++band)
+    {
+        settings.bands[band].freq = ratio(a.bands[band].freq, b.bands[band].freq);
+        settings.bands[band].quality = ratio(a.bands[band].quality, b.bands[band].quality);
+        settings.bands[band].gainInDecibels = linear(a.bands[band].gainInDecibels, b.bands[band].gainInDecibels);
+    }
+
+    settings.globalBypassed = live.globalBypassed;
+    settings.linearPhase = live.linearPhase;
+    settings.processingMode = live.processingMode;
+    settings.topology = live.topology;
+    settings.oversamplingFactor = live.oversamplingFactor;
+    settings.oversamplingFilter = live.oversamplingFilter;
+    settings.oversamplingThreshold = live.oversamplingThreshold;
+
+    return settings;
+}
+
+void SnapshotMorph::designBlendedSections(EQSectionList<double>& sections, const ChainSettings& from, const ChainSettings& to,
+                                          double amount, double sampleRate)
+{
+    EQSectionList<double> fromSections, toSections;
+    makeSectionList(fromSections, from, sampleRate);
+    makeSectionList(toSections, to, sampleRate);
+
+    blendSections(sections, fromSections, toSections, amount);
+}
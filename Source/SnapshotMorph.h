@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+
+    SnapshotMorph.h
+    A/B (up to four-way) snapshots of the EQ kept outside the apvts, with a
+    morph control that moves through them in order. The message thread
+    stores snapshots into one of three fixed copies and publishes it by
+    index; the audio thread announces the copy it is reading, so the next
+    store never writes over it. Neither side locks or allocates.
+
+    The engine designs each snapshot once per sample rate and, while the
+    morph moves, only blends the coefficients of the two snapshots either
+    side of it. Biquads blend safely: the stability region of the feedback
+    coefficients is convex, and a slot only one snapshot uses blends to or
+    from a pass-through section.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "ChainSettings.h"
+
+class SnapshotMorph
+{
+public:
+    static constexpr int maxSnapshots = 4;
+
+    struct Snapshots
+    {
+        std::array<ChainSettings, maxSnapshots> settings;
+        std::array<bool, maxSnapshots> stored{};
+
+        //changes with every store, so the engine knows when to redesign its copies
+        juce::uint32 generation = 0;
+
+        int getNumStored() const;
+    };
+
+    /** The two stored snapshots either side of a morph position, and how far it is from the first to the second. */
+    struct Segment
+    {
+        int from = 0, to = 0;
+        float amount = 0.f;
+    };
+
+    /** Stores settings as snapshot index, 0 being A. Message thread only. */
+    void store(int index, const ChainSettings& settings);
+
+    /** Forgets every snapshot. Message thread only. */
+    void clear();
+
+    int getNumStored() const { return master.getNumStored(); }
+
+    /** The stored snapshots as the message thread last left them. */
+    const Snapshots& getStored() const { return master; }
+
+    /** The current snapshots for the audio thread, valid until its next call. */
+    const Snapshots& acquire();
+
+    /** Spreads the stored snapshots evenly over 0 to 1. Returns false when fewer than two are stored. */
+    static bool findSegment(const Snapshots& snapshots, float position, Segment& segment);
+
+    /** The settings part way along a segment. Frequencies and Q move in equal ratios and gains in equal dB,
+        while slopes and switches come from the nearer snapshot. Processing mode, topology, linear phase,
+        oversampling and the global bypass aren't morphed and are kept from live.
+
+        These only approximate what is heard, which is the blend of the snapshots' sections, so they decide
+        the modes and when the oversampler engages but not the response. The linear-phase kernel and the
+        response curve are drawn from designBlendedSections() instead.
+    */
+    static ChainSettings getMorphedSettings(const Snapshots& snapshots, const Segment& segment, const ChainSettings& live);
+
+    /** Designs two snapshots at a rate and blends their sections as the engine does, for the paths that
+        have to match it away from the engine: the linear-phase kernel and the response curve.
+    */
+    static void designBlendedSections(EQSectionList<double>& sections, const ChainSettings& from, const ChainSettings& to,
+                                      double amount, double sampleRate);
+
+    /** Blends the designed sections of two snapshots into a list of either topology at the engine's precision. */
+    template<typename CoefficientType>
+    static void blendSections(SectionList<CoefficientType, MaxSections>& sections,
+                              const EQSectionList<double>& from, const EQSectionList<double>& to, double amount)
+    {
+        const BiquadCoefficients<double> passThrough;
+
+        for (int slot = 0; slot < MaxSections; ++slot)
+        {
+            sections.active[slot] = from.active[slot] || to.active[slot];
+
+            if (!sections.active[slot])
+                continue;
+
+            const auto& a = from.active[slot] ? from.coefficients[slot] : passThrough;
+            const auto& b = to.active[slot] ? to.coefficients[slot] : passThrough;
+
+            const BiquadCoefficients<double> blended{ a.b0 + amount * (b.b0 - a.b0), a.b1 + amount * (b.b1 - a.b1),
+                                                      a.b2 + amount * (b.b2 - a.b2), a.a1 + amount * (b.a1 - a.a1),
+                                                      a.a2 + amount * (b.a2 - a.a2) };
+
+            convertSection(blended, sections.coefficients[slot]);
+        }
+    }
+
+private:
+    //written on the message thread only
+    Snapshots master;
+
+    //one copy is published, the audio thread may still be reading another, and the third is free to write
+    std::array<Snapshots, 3> copies;
+    std::atomic<int> published{ 0 };
+    std::atomic<int> reading{ -1 };
+
+    void publish();
+};
@@ -0,0 +1,217 @@
+/*
+  ==============================================================================
+
+    StateSerialiser.cpp
+
+  ==============================================================================
+*/
+
+#include "StateSerialiser.h"
+#include <numeric>
+#include <set>
+
+namespace
+{
+    struct BlockLayout
+    {
+        int headerSize = 0, numEntries = 0, entrySize = 0;
+
+        juce::int64 getEntriesEnd() const { return headerSize + (juce::int64)numEntries * entrySize; }
+    };
+
+    bool readBlockLayout(const void* data, int sizeInBytes, BlockLayout& layout)
+    {
+        if (data == nullptr || sizeInBytes < StateSerialiser::headerSize)
+            return false;
+
+        juce::MemoryInputStream stream(data, (size_t)sizeInBytes, false);
+
+        if ((juce::uint32)stream.readInt() != StateSerialiser::magic)
+            return false;
+
+        const auto version = (int)stream.readShort();
+        layout.headerSize = (int)(juce::uint16)stream.readShort();
+        layout.numEntries = (int)(juce::uint16)stream.readShort();
+        layout.entrySize = (int)(juce::uint16)stream.readShort();
+
+        return version >= 1 && layout.headerSize >= StateSerialiser::headerSize && layout.entrySize >= StateSerialiser::entrySize
+            && layout.getEntriesEnd() <= sizeInBytes;
+    }
+}
+
+StateSerialiser::StateSerialiser(juce::AudioProcessor& processor)
+{
+    for (auto* parameter : processor.getParameters())
+    {
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+        {
+            parameters.push_back(ranged);
+            idHashes.push_back(hashParameterID(ranged->getParameterID()));
+        }
+    }
+
+    //two IDs sharing a hash would make a block ambiguous
+    jassert(std::set<juce::uint32>(idHashes.begin(), idHashes.end()).size() == idHashes.size());
+}
+
+void StateSerialiser::write(juce::MemoryBlock& destData, const std::vector<Extension>& extensions) const
+{
+    std::vector<float> values;
+    values.reserve(parameters.size());
+
+    for (auto* parameter : parameters)
+        values.push_back(parameter->getValue());
+
+    write(destData, values);
+
+    if (extensions.empty())
+        return;
+
+    juce::MemoryOutputStream stream(destData, true);
+
+    for (const auto& extension : extensions)
+    {
+        stream.writeInt((int)extension.tag);
+        stream.writeInt((int)extension.data.getSize());
+        stream.write(extension.data.getData(), extension.data.getSize());
+    }
+}
+
+void StateSerialiser::write(juce::MemoryBlock& destData, const std::vector<float>& normalisedValues) const
+{
+    std::vector<int> parameterIndices((size_t)getNumParameters());
+    std::iota(parameterIndices.begin(), parameterIndices.end(), 0);
+
+    write(destData, normalisedValues, parameterIndices);
+}
+
+void StateSerialiser::write(juce::MemoryBlock& destData, const std::vector<float>& normalisedValues, const std::vector<int>& parameterIndices) const
+{
+    jassert(normalisedValues.size() == parameters.size());
+    juce::MemoryOutputStream stream(destData, true);
+
+    //MemoryOutputStream writes little-endian on every platform
+    stream.writeInt((int)magic);
+    stream.writeShort((short)currentVersion);
+    stream.writeShort((short)headerSize);
+    stream.writeShort((short)parameterIndices.size());
+    stream.writeShort((short)entrySize);
+
+    for (auto index : parameterIndices)
+    {
+        stream.writeInt((int)idHashes[(size_t)index]);
+        stream.writeFloat(normalisedValues[(size_t)index]);
+    }
+}
+
+bool StateSerialiser::read(const void* data, int sizeInBytes) const
+{
+    return readEntries(data, sizeInBytes, [this](int index, float value)
+    {
+        auto* parameter = parameters[(size_t)index];
+
+        //most of a session's parameters usually sit where they already are
+        if (parameter->getValue() != value)
+            parameter->setValueNotifyingHost(value);
+    });
+}
+
+bool StateSerialiser::readValues(const void* data, int sizeInBytes, std::vector<float>& normalisedValues) const
+{
+    jassert(normalisedValues.size() == parameters.size());
+
+    return readEntries(data, sizeInBytes, [&normalisedValues](int index, float value)
+    {
+        normalisedValues[(size_t)index] = value;
+    });
+}
+
+template<typename EntryRead>
+bool StateSerialiser::readEntries(const void* data, int sizeInBytes, EntryRead&& entryRead) const
+{
+    BlockLayout layout;
+
+    if (!readBlockLayout(data, sizeInBytes, layout))
+        return false;
+
+    juce::MemoryInputStream stream(data, (size_t)sizeInBytes, false);
+
+    for (int entry = 0; entry < layout.numEntries; ++entry)
+    {
+        stream.setPosition(layout.headerSize + (juce::int64)entry * layout.entrySize);
+
+        const auto idHash = (juce::uint32)stream.readInt();
+        const auto value = stream.readFloat();
+
+        //parameters that have since been removed are skipped; ones added since keep their current values
+        const auto index = findParameter(idHash, entry);
+        if (index < 0 || !std::isfinite(value))
+            continue;
+
+        entryRead(index, juce::jlimit(0.f, 1.f, value));
+    }
+
+    return true;
+}
+
+bool StateSerialiser::findExtension(const void* data, int sizeInBytes, juce::uint32 tag, juce::MemoryBlock& extension)
+{
+    BlockLayout layout;
+
+    if (!readBlockLayout(data, sizeInBytes, layout))
+        return false;
+
+    juce::MemoryInputStream stream(data, (size_t)sizeInBytes, false);
+    auto position = layout.getEntriesEnd();
+
+    while (position + extensionHeaderSize <= sizeInBytes)
+    {
+        stream.setPosition(position);
+
+        const auto extensionTag = (juce::uint32)stream.readInt();
+        const auto extensionSize = (juce::int64)(juce::uint32)stream.readInt();
+        position += extensionHeaderSize;
+
+        if (position + extensionSize > sizeInBytes)
+            return false;
+
+        if (extensionTag == tag)
+        {
+            extension.replaceAll(static_cast<const char*>(data) + position, (size_t)extensionSize);
+            return true;
+        }
+
+        position += extensionSize;
+    }
+
+    return false;
+}
+
+juce::uint32 StateSerialiser::hashParameterID(const juce::String& parameterID)
+{
+    //32-bit FNV-1a over the UTF-8 bytes, which is the same on every platform and in every build
+    juce::uint32 hash = 2166136261u;
+
+    for (auto* c = parameterID.toRawUTF8(); *c != 0; ++c)
+    {
+        hash ^= (juce::uint8)*c;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+int StateSerialiser::findParameter(juce::uint32 idHash, int expectedIndex) const
+{
+    //a block from the same layout lines up entry for entry
+    if (expectedIndex < (int)idHashes.size() && idHashes[(size_t)expectedIndex] == idHash)
+        return expectedIndex;
+
+    for (size_t index = 0; index < idHashes.size(); ++index)
+    {
+        if (idHashes[index] == idHash)
+            return (int)index;
+    }
+
+    return -1;
+}
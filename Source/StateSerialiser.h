@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    StateSerialiser.h
+    The plugin state as a compact, versioned binary block instead of the
+    apvts ValueTree. After a small header, each parameter is stored as a
+    fixed-size entry of an ID hash and its normalised value, in parameter
+    order. A block saved by the same layout loads in one pass with no
+    parsing, no string handling and no allocation. The hashes still let
+    blocks from other layouts load by ID, and the header's sizes let older
+    readers skip anything a later version appends.
+
+    State that isn't a parameter follows the entries as optional extension
+    sections, each a tag, a size and that many bytes. Readers look up the
+    tags they know and skip the rest, and blocks without any still load.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+class StateSerialiser
+{
+public:
+    static constexpr juce::uint32 magic = 0x42514553; // "SEQB"
+    static constexpr int currentVersion = 1;
+
+    //magic, version, header size, number of entries, entry size
+    static constexpr int headerSize = 4 + 2 + 2 + 2 + 2;
+
+    //id hash, normalised value
+    static constexpr int entrySize = 4 + 4;
+
+    /** Caches the parameters of the processor and the hashes of their IDs. */
+    explicit StateSerialiser(juce::AudioProcessor& processor);
+
+    //tag, size in bytes
+    static constexpr int extensionHeaderSize = 4 + 4;
+
+    struct Extension
+    {
+        juce::uint32 tag;
+        juce::MemoryBlock data;
+    };
+
+    /** Writes the current values, followed by any extensions. */
+    void write(juce::MemoryBlock& destData, const std::vector<Extension>& extensions = {}) const;
+
+    /** Writes a block holding the given normalised values, one per parameter, instead of the current ones. */
+    void write(juce::MemoryBlock& destData, const std::vector<float>& normalisedValues) const;
+
+    /** Writes a block holding only the listed parameters' values, so reading it leaves every other parameter alone. */
+    void write(juce::MemoryBlock& destData, const std::vector<float>& normalisedValues, const std::vector<int>& parameterIndices) const;
+
+    /** Applies a block written by write(), setting only the parameters whose values differ.
+        Returns false, changing nothing, when the data isn't in this format.
+    */
+    bool read(const void* data, int sizeInBytes) const;
+
+    /** Reads a block's values into normalisedValues, one per parameter, without touching the parameters.
+        Values the block doesn't hold are left as they are. Returns false when the data isn't in this format.
+    */
+    bool readValues(const void* data, int sizeInBytes, std::vector<float>& normalisedValues) const;
+
+    /** Copies out the first extension with the tag. Returns false when the block has none or isn't in this format. */
+    static bool findExtension(const void* data, int sizeInBytes, juce::uint32 tag, juce::MemoryBlock& extension);
+
+    static juce::uint32 hashParameterID(const juce::String& parameterID);
+
+    int getNumParameters() const { return (int)parameters.size(); }
+    juce::RangedAudioParameter& getParameter(int index) const { return *parameters[(size_t)index]; }
+
+private:
+    std::vector<juce::RangedAudioParameter*> parameters;
+    std::vector<juce::uint32> idHashes;
+
+    int findParameter(juce::uint32 idHash, int expectedIndex) const;
+
+    /** Calls entryRead(index, value) for each finite value in the block that belongs to a current parameter. */
+    template<typename EntryRead>
+    bool readEntries(const void* data, int sizeInBytes, EntryRead&& entryRead) const;
+};
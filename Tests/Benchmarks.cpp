@@ -0,0 +1,395 @@
+/*
+  ==============================================================================
+
+    Benchmarks.cpp
+    Timings of the parts of the plugin whose cost a request promised something
+    about. They log what they measure and only fail when the structure behind
+    the promise is broken, since wall-clock numbers vary from machine to
+    machine.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+#include "../Source/FFTBackend.h"
+
+namespace
+{
+    void fillWithNoise(juce::AudioBuffer<float>& buffer, juce::Random& random)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample(channel, i, random.nextFloat() * 2.f - 1.f);
+        }
+    }
+
+    /** The fastest of a few runs, in seconds, which is the least disturbed by whatever else the machine is doing. */
+    template<typename Run>
+    double timeBestOf(int numRuns, Run&& run)
+    {
+        auto best = std::numeric_limits<double>::max();
+
+        for (int attempt = 0; attempt < numRuns; ++attempt)
+        {
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            run();
+            best = juce::jmin(best, juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks));
+        }
+
+        return best;
+    }
+
+    /** Renders the source through the engine a block at a time, copying each block in first so the
+        source stays untouched for the next run.
+    */
+    template<typename SampleType>
+    void renderThrough(EQEngine<SampleType>& engine, const juce::AudioBuffer<SampleType>& source, juce::AudioBuffer<SampleType>& block)
+    {
+        for (int offset = 0; offset + block.getNumSamples() <= source.getNumSamples(); offset += block.getNumSamples())
+        {
+            for (int channel = 0; channel < block.getNumChannels(); ++channel)
+                block.copyFrom(channel, 0, source, channel, offset, block.getNumSamples());
+
+            engine.process(block);
+        }
+    }
+}
+
+//==============================================================================
+/** What one control-rate tick costs when the host automates a parameter on every callback, at host
+    block sizes below, at and above the tick length. The number of ticks has to follow the control
+    clock rather than the callbacks.
+*/
+class ControlTickBenchmark : public juce::UnitTest
+{
+public:
+    ControlTickBenchmark() : juce::UnitTest("Control-rate tick cost", "Benchmarks") {}
+
+    void runTest() override
+    {
+        constexpr double sampleRate = 96000.0;
+        constexpr int numSamples = 96000 * 4;
+
+        auto random = getRandom();
+
+        for (auto blockSize : { 16, 64, 512 })
+        {
+            beginTest("Blocks of " + juce::String(blockSize) + " samples");
+
+            SimpleEQAudioProcessor processor;
+            processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+            processor.prepareToPlay(sampleRate, blockSize);
+
+            auto* peakFreq = processor.apvts.getParameter(getParameterID(Param_PeakFreq));
+            const auto tickLength = controlRateTickLengths[(int)processor.apvts.getRawParameterValue(getParameterID(Param_ControlRate))->load()];
+
+            juce::AudioBuffer<float> buffer(2, blockSize);
+            juce::MidiBuffer midi;
+
+            for (int block = 0; block < numSamples / blockSize; ++block)
+            {
+                peakFreq->setValueNotifyingHost(random.nextFloat());
+                fillWithNoise(buffer, random);
+                processor.processBlock(buffer, midi);
+            }
+
+            const auto stats = processor.getControlTickStats();
+
+            logMessage(juce::String(stats.numTicks) + " ticks of " + juce::String(tickLength) + " samples, "
+                       + juce::String(stats.getAverageSeconds() * 1.0e6, 2) + " us on average, "
+                       + juce::String(stats.maxSeconds * 1.0e6, 2) + " us at most");
+
+            expect(stats.numTicks > 0, "the automation never reached a tick");
+            expect(stats.numTicks <= numSamples / tickLength + 1, "there were more ticks than the control clock has");
+        }
+    }
+};
+
+static ControlTickBenchmark controlTickBenchmark;
+
+//==============================================================================
+/** The matched-response design only changes how each section's coefficients are worked out, so
+    with the same bands active it should run at the same per-sample cost as the RBJ design.
+*/
+class MatchedDesignBenchmark : public juce::UnitTest
+{
+public:
+    MatchedDesignBenchmark() : juce::UnitTest("Matched-response design cost", "Benchmarks") {}
+
+    void runTest() override
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 512, numSamples = 48000 * 5;
+
+        ChainSettings settings;
+        settings.peakFreq = 15000.f;
+        settings.peakGainInDecibels = 6.f;
+        settings.peakQuality = 2.f;
+
+        const std::pair<BandType, float> highBands[] = { { Band_Peak, 18000.f }, { Band_HighShelf, 12000.f }, { Band_Peak, 9000.f } };
+
+        for (size_t band = 0; band < std::size(highBands); ++band)
+        {
+            settings.bands[band].enabled = true;
+            settings.bands[band].type = highBands[band].first;
+            settings.bands[band].freq = highBands[band].second;
+            settings.bands[band].gainInDecibels = -4.f;
+        }
+
+        juce::AudioBuffer<float> noise(2, numSamples);
+        auto random = getRandom();
+        fillWithNoise(noise, random);
+
+        for (auto topology : { Topology_Biquad, Topology_SVF })
+        {
+            beginTest(topology == Topology_SVF ? "State-variable topology" : "Biquad topology");
+            settings.topology = topology;
+
+            double seconds[2];
+            int numSections[2];
+
+            for (int matched = 0; matched < 2; ++matched)
+            {
+                settings.matchedResponse = matched == 1;
+
+                EQSectionList<float> sections;
+                makeSectionList(sections, settings, sampleRate);
+                numSections[matched] = (int)std::count(sections.active.begin(), sections.active.end(), true);
+
+                EQEngine<float> engine;
+                engine.prepare({ sampleRate, (juce::uint32)blockSize, 2 });
+                engine.updateFilters(settings, sampleRate);
+
+                juce::AudioBuffer<float> block(2, blockSize);
+                seconds[matched] = timeBestOf(5, [&] { renderThrough(engine, noise, block); });
+            }
+
+            const auto ratio = seconds[1] / seconds[0];
+
+            logMessage("RBJ " + juce::String(seconds[0] * 1.0e9 / numSamples, 2) + " ns per sample, matched "
+                       + juce::String(seconds[1] * 1.0e9 / numSamples, 2) + " ns per sample, ratio " + juce::String(ratio, 3));
+
+            //the matched design only changes the coefficients, so the audio path runs the same sections either way
+            expectEquals(numSections[1], numSections[0]);
+        }
+    }
+};
+
+static MatchedDesignBenchmark matchedDesignBenchmark;
+
+//==============================================================================
+/** What restoring a session costs each plugin instance, in the binary format and in the apvts
+    ValueTree format it replaced. Each load switches every instance between two states, so every
+    parameter moves every time.
+*/
+class StateLoadBenchmark : public juce::UnitTest
+{
+public:
+    StateLoadBenchmark() : juce::UnitTest("Per-instance state load cost", "Benchmarks") {}
+
+    void runTest() override
+    {
+        constexpr int numInstances = 32;
+
+        std::vector<std::unique_ptr<SimpleEQAudioProcessor>> instances;
+
+        for (int instance = 0; instance < numInstances; ++instance)
+            instances.push_back(std::make_unique<SimpleEQAudioProcessor>());
+
+        auto& source = *instances.front();
+        juce::MemoryBlock defaultState, randomState;
+        source.getStateInformation(defaultState);
+
+        auto random = getRandom();
+
+        for (auto* parameter : source.getParameters())
+            parameter->setValueNotifyingHost(random.nextFloat());
+
+        source.getStateInformation(randomState);
+        const auto expectedValues = getValues(source);
+
+        const auto legacyDefaultState = writeLegacyState(*instances.back());
+        const auto legacyRandomState = writeLegacyState(source);
+
+        beginTest("Binary format");
+        const auto binarySeconds = timeLoads(instances, defaultState, randomState);
+        expectValues(*instances.back(), expectedValues);
+
+        beginTest("Legacy ValueTree format");
+        const auto legacySeconds = timeLoads(instances, legacyDefaultState, legacyRandomState);
+        expectValues(*instances.back(), expectedValues);
+
+        logMessage("binary " + juce::String(binarySeconds * 1.0e6, 2) + " us per instance ("
+                   + juce::String((int)randomState.getSize()) + " bytes), legacy "
+                   + juce::String(legacySeconds * 1.0e6, 2) + " us per instance ("
+                   + juce::String((int)legacyRandomState.getSize()) + " bytes)");
+    }
+
+private:
+    static std::vector<float> getValues(SimpleEQAudioProcessor& processor)
+    {
+        std::vector<float> values;
+
+        for (auto* parameter : processor.getParameters())
+            values.push_back(parameter->getValue());
+
+        return values;
+    }
+
+    //the ValueTree stores denormalised values, so those come back only to within rounding
+    void expectValues(SimpleEQAudioProcessor& processor, const std::vector<float>& expectedValues)
+    {
+        const auto values = getValues(processor);
+
+        for (size_t index = 0; index < values.size(); ++index)
+            expectWithinAbsoluteError(values[index], expectedValues[index], 1.0e-4f);
+    }
+
+    static juce::MemoryBlock writeLegacyState(SimpleEQAudioProcessor& processor)
+    {
+        juce::MemoryBlock block;
+        juce::MemoryOutputStream stream(block, false);
+        processor.apvts.copyState().writeToStream(stream);
+        return block;
+    }
+
+    /** Seconds per instance for the fastest of a few passes that load one state and then the other
+        into every instance, ending on the second.
+    */
+    static double timeLoads(std::vector<std::unique_ptr<SimpleEQAudioProcessor>>& instances,
+                            const juce::MemoryBlock& first, const juce::MemoryBlock& second)
+    {
+        const auto seconds = timeBestOf(5, [&]
+        {
+            for (auto& instance : instances)
+            {
+                instance->setStateInformation(first.getData(), (int)first.getSize());
+                instance->setStateInformation(second.getData(), (int)second.getSize());
+            }
+        });
+
+        return seconds / (2 * (int)instances.size());
+    }
+};
+
+static StateLoadBenchmark stateLoadBenchmark;
+
+//==============================================================================
+/** The parallel form against the serial biquad chain it is expanded from, with both cuts at 48 dB/oct
+    and the peak in, which is where the serial chain is longest.
+*/
+class ParallelFormBenchmark : public juce::UnitTest
+{
+public:
+    ParallelFormBenchmark() : juce::UnitTest("Parallel form cost", "Benchmarks") {}
+
+    void runTest() override
+    {
+        run<float>("Single precision");
+        run<double>("Double precision");
+    }
+
+private:
+    template<typename SampleType>
+    void run(const juce::String& name)
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 512, numSamples = 48000 * 5;
+
+        beginTest(name);
+
+        ChainSettings settings;
+        settings.lowCutFreq = 80.f;
+        settings.lowCutSlope = Slope_48;
+        settings.highCutFreq = 12000.f;
+        settings.highCutSlope = Slope_48;
+        settings.peakFreq = 1000.f;
+        settings.peakGainInDecibels = 6.f;
+        settings.peakQuality = 1.f;
+
+        //otherwise the engine falls back to the serial chain and both timings measure the same thing
+        EQSectionList<SampleType> sections;
+        makeSectionList(sections, settings, sampleRate);
+        ParallelForm::Expansion<MaxSections> expansion;
+        expect(ParallelForm::expand(sections, expansion, sampleRate, ParallelForm::getMaxGainSpread<SampleType>()),
+               "the cascade doesn't expand, so there is no parallel form to time");
+
+        juce::AudioBuffer<float> floatNoise(2, numSamples);
+        auto random = getRandom();
+        fillWithNoise(floatNoise, random);
+
+        juce::AudioBuffer<SampleType> noise;
+        noise.makeCopyOf(floatNoise);
+
+        double seconds[2];
+        const FilterTopology topologies[] = { Topology_Biquad, Topology_Parallel };
+
+        for (int index = 0; index < 2; ++index)
+        {
+            settings.topology = topologies[index];
+
+            EQEngine<SampleType> engine;
+            engine.prepare({ sampleRate, (juce::uint32)blockSize, 2 });
+            engine.updateFilters(settings, sampleRate);
+
+            juce::AudioBuffer<SampleType> block(2, blockSize);
+            seconds[index] = timeBestOf(5, [&] { renderThrough(engine, noise, block); });
+        }
+
+        logMessage("serial " + juce::String(seconds[0] * 1.0e9 / numSamples, 2) + " ns per sample, parallel "
+                   + juce::String(seconds[1] * 1.0e9 / numSamples, 2) + " ns per sample, ratio "
+                   + juce::String(seconds[1] / seconds[0], 3));
+    }
+};
+
+static ParallelFormBenchmark parallelFormBenchmark;
+
+//==============================================================================
+/** What a transform costs on each FFT backend at the analyzer's orders, so the default can be chosen
+    per platform.
+*/
+class FFTBackendBenchmark : public juce::UnitTest
+{
+public:
+    FFTBackendBenchmark() : juce::UnitTest("FFT backend cost", "Benchmarks") {}
+
+    void runTest() override
+    {
+        constexpr int numTransforms = 32;
+
+        for (int order = 11; order <= 13; ++order)
+        {
+            beginTest("Order " + juce::String(order));
+
+            const auto size = 1 << order;
+            std::vector<float> input((size_t)(2 * size), 0.f), data(input.size());
+
+            auto random = getRandom();
+
+            for (int i = 0; i < size; ++i)
+                input[(size_t)i] = random.nextFloat() * 2.f - 1.f;
+
+            for (int type = 0; type < NumFFTBackendTypes; ++type)
+            {
+                auto fft = FFTBackend::create((FFTBackendType)type, order);
+
+                const auto seconds = timeBestOf(5, [&]
+                {
+                    for (int transform = 0; transform < numTransforms; ++transform)
+                    {
+                        std::copy(input.begin(), input.end(), data.begin());
+                        fft->performMagnitudeTransform(data.data());
+                    }
+                });
+
+                logMessage(juce::String(FFTBackend::getTypeName((FFTBackendType)type)) + ": "
+                           + juce::String(seconds * 1.0e6 / numTransforms, 2) + " us per transform"
+                           + (type == FFTBackend::getActiveType() ? " (active)" : ""));
+            }
+        }
+    }
+};
+
+static FFTBackendBenchmark fftBackendBenchmark;
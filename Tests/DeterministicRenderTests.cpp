@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+
+    DeterministicRenderTests.cpp
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/EQEngine.h"
+#include "../Source/ControlRateScheduler.h"
+#include <cstring>
+
+/** A deterministic render has to give the same bits whichever way the host splits its blocks and
+    whichever kernel variant the CPU picks, so every render, of every block size under every variant,
+    is checked against one reference.
+*/
+class DeterministicRenderTests : public juce::UnitTest
+{
+public:
+    DeterministicRenderTests() : juce::UnitTest("Deterministic rendering", "SimpleEQ") {}
+
+    void runTest() override
+    {
+        const auto activeIsa = KernelDispatch::getActiveIsa();
+
+        for (int numChannels = 1; numChannels <= 2; ++numChannels)
+        {
+            beginTest(numChannels == 1 ? "Mono" : "Stereo");
+
+            expectStable<float>(numChannels);
+            expectStable<double>(numChannels);
+        }
+
+        KernelDispatch::setActiveIsa(activeIsa);
+    }
+
+private:
+    template<typename SampleType>
+    void expectStable(int numChannels)
+    {
+        KernelDispatch::setActiveIsa(Isa_Generic);
+        const auto reference = renderHash<SampleType>(44100.0, numChannels, 512);
+
+        for (int isa = 0; isa < NumKernelIsas; ++isa)
+        {
+            if (!KernelDispatch::setActiveIsa((KernelIsa)isa))
+                continue;
+
+            for (auto blockSize : { 1, 37, 64, 441, 512, 4096 })
+            {
+                expect(renderHash<SampleType>(44100.0, numChannels, blockSize) == reference,
+                       juce::String(sizeof(SampleType) == sizeof(float) ? "float" : "double") + " render in blocks of "
+                       + juce::String(blockSize) + " under " + KernelDispatch::getIsaName((KernelIsa)isa) + " differs");
+            }
+        }
+    }
+
+    /** Renders a fixed stretch of noise with a silent gap through a fresh deterministic engine, in blocks of
+        blockSize, moving the peak and toggling the bypass on the control clock the processor uses, and
+        returns a hash of the output.
+    */
+    template<typename SampleType>
+    static juce::uint64 renderHash(double sampleRate, int numChannels, int blockSize)
+    {
+        constexpr int numSamples = 8192, tickLength = controlRateTickLengths[0];
+
+        auto engine = std::make_unique<EQEngine<SampleType>>();
+        engine->setDeterministic(true);
+        engine->prepare({ sampleRate, (juce::uint32)blockSize, (juce::uint32)numChannels });
+
+        juce::AudioBuffer<SampleType> signal(numChannels, numSamples);
+        juce::Random random(0x5eed);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            for (int i = 0; i < numSamples; ++i)
+                signal.setSample(channel, i, i >= 3000 && i < 6000 ? SampleType(0) : static_cast<SampleType>(random.nextDouble() - 0.5));
+        }
+
+        ChainSettings settings;
+        settings.lowCutFreq = 80.f;
+        settings.lowCutSlope = Slope_48;
+        settings.highCutFreq = 12000.f;
+        settings.highCutSlope = Slope_24;
+        settings.peakGainInDecibels = 6.f;
+        settings.peakQuality = 2.f;
+
+        ControlRateScheduler scheduler;
+        scheduler.setTickLength(tickLength);
+        int tick = 0, numUpdates = 0;
+
+        for (int offset = 0; offset < numSamples; offset += blockSize)
+        {
+            const auto length = juce::jmin(blockSize, numSamples - offset);
+            juce::AudioBuffer<SampleType> block(signal.getArrayOfWritePointers(), numChannels, offset, length);
+
+            //an update every eighth tick, so the ramps settle in between and the blocks cut across steady stretches
+            scheduler.processBlock(length,
+                [&] { return tick++ % 8 == 0; },
+                [&]
+                {
+                    settings.peakFreq = 200.f * std::pow(2.f, float(numUpdates % 12) / 2.f);
+                    settings.globalBypassed = (numUpdates / 4) % 3 == 1;
+                    engine->updateFilters(settings, sampleRate, tickLength);
+                    ++numUpdates;
+                },
+                [&](int rangeStart, int rangeLength)
+                {
+                    juce::AudioBuffer<SampleType> range(block.getArrayOfWritePointers(), numChannels, rangeStart, rangeLength);
+                    engine->process(range);
+                });
+        }
+
+        //FNV-1a over the bits of every sample
+        juce::uint64 hash = 14695981039346656037ull;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto sample = signal.getSample(channel, i);
+                std::array<unsigned char, sizeof(SampleType)> bytes;
+                std::memcpy(bytes.data(), &sample, sizeof(SampleType));
+
+                for (auto byte : bytes)
+                    hash = (hash ^ byte) * 1099511628211ull;
+            }
+        }
+
+        return hash;
+    }
+};
+
+static DeterministicRenderTests deterministicRenderTests;
@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    FFTBackendTests.cpp
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/FFTBackend.h"
+#include <algorithm>
+#include <vector>
+
+/** Every backend has to give the same magnitudes as the JUCE one at the analyzer's orders. */
+class FFTBackendTests : public juce::UnitTest
+{
+public:
+    FFTBackendTests() : juce::UnitTest("FFT backends", "SimpleEQ") {}
+
+    void runTest() override
+    {
+        for (int order = 11; order <= 13; ++order)
+        {
+            beginTest("Order " + juce::String(order));
+
+            const auto size = 1 << order;
+            const auto numBins = size / 2 + 1;
+
+            juce::Random random(0x5e13 + order);
+            std::vector<float> input((size_t)(2 * size), 0.f);
+
+            for (int i = 0; i < size; ++i)
+                input[(size_t)i] = random.nextFloat() * 2.f - 1.f;
+
+            auto reference = input;
+            FFTBackend::create(FFTBackend_Juce, order)->performMagnitudeTransform(reference.data());
+
+            //the rounding grows with the size of the transform, so the tolerance is taken from the largest bin
+            const auto tolerance = 1.0e-4f * *std::max_element(reference.begin(), reference.begin() + numBins);
+
+            for (int type = 0; type < NumFFTBackendTypes; ++type)
+            {
+                if (type == FFTBackend_Juce)
+                    continue;
+
+                auto output = input;
+                FFTBackend::create((FFTBackendType)type, order)->performMagnitudeTransform(output.data());
+
+                float worstError = 0.f;
+
+                for (int bin = 0; bin < numBins; ++bin)
+                    worstError = juce::jmax(worstError, std::abs(output[(size_t)bin] - reference[(size_t)bin]));
+
+                expectLessOrEqual(worstError, tolerance, juce::String(FFTBackend::getTypeName((FFTBackendType)type))
+                                                             + " disagrees with the JUCE transform");
+            }
+        }
+    }
+};
+
+static FFTBackendTests fftBackendTests;
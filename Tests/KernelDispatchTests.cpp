@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    KernelDispatchTests.cpp
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/BiquadCascade.h"
+#include <cstdlib>
+#include <vector>
+
+/** Forces each kernel variant this machine supports through the override environment variable and
+    checks it, and the deterministic kernels, against the generic variant. The wider variants may
+    fuse multiplies and adds, so agreement is to within rounding rather than bit for bit.
+*/
+class KernelDispatchTests : public juce::UnitTest
+{
+public:
+    KernelDispatchTests() : juce::UnitTest("Kernel dispatch", "SimpleEQ") {}
+
+    void runTest() override
+    {
+        for (int isa = 0; isa < NumKernelIsas; ++isa)
+        {
+            if (!KernelDispatch::isSupported((KernelIsa)isa))
+                continue;
+
+            beginTest(juce::String("Variant ") + KernelDispatch::getIsaName((KernelIsa)isa));
+
+            setIsaOverride(KernelDispatch::getIsaName((KernelIsa)isa));
+            const auto chosen = KernelDispatch::chooseIsa();
+            expectEquals((int)chosen, isa, "the override didn't pick the variant it names");
+
+            expectFilterKernelsAgree<float>(KernelDispatch::getFilterKernels<float>(chosen));
+            expectFilterKernelsAgree<double>(KernelDispatch::getFilterKernels<double>(chosen));
+            expectSpectrumKernelsAgree(KernelDispatch::getSpectrumKernels(chosen));
+        }
+
+        beginTest("Deterministic kernels");
+        expectFilterKernelsAgree<float>(KernelDispatch::getDeterministicFilterKernels<float>());
+        expectFilterKernelsAgree<double>(KernelDispatch::getDeterministicFilterKernels<double>());
+
+        beginTest("Unknown override");
+        setIsaOverride("");
+        const auto widest = KernelDispatch::chooseIsa();
+        setIsaOverride("mmx");
+        expectEquals((int)KernelDispatch::chooseIsa(), (int)widest, "an unknown name should leave the widest variant chosen");
+
+        setIsaOverride("");
+    }
+
+private:
+    static void setIsaOverride(const char* name)
+    {
+       #if JUCE_WINDOWS
+        _putenv_s(KernelDispatch::isaEnvironmentVariable, name);
+       #else
+        setenv(KernelDispatch::isaEnvironmentVariable, name, 1);
+       #endif
+    }
+
+    template<typename SampleType>
+    static bool isClose(SampleType value, SampleType reference)
+    {
+        const auto tolerance = std::is_same_v<SampleType, float> ? 1.0e-4 : 1.0e-10;
+        return std::abs(double(value) - double(reference)) <= tolerance * (1.0 + std::abs(double(reference)));
+    }
+
+    template<typename SampleType>
+    void expectFilterKernelsAgree(const KernelDispatch::FilterKernels<SampleType>& kernels)
+    {
+        constexpr int lanes = 8, numFrames = 67, numBlocks = 9;
+        constexpr int length = BiquadBlockKernel<SampleType>::length;
+
+        //a resonant but comfortably stable section, so differences in rounding show without blowing up
+        const BiquadCoefficients<SampleType> c{ SampleType(0.2), SampleType(0.1), SampleType(-0.15), SampleType(-1.6), SampleType(0.8) };
+        BiquadBlockKernel<SampleType> kernel;
+        TDF2Biquad<SampleType>::designBlockKernel(c, kernel);
+
+        juce::Random random(0x5e11);
+        std::vector<SampleType> input((size_t)juce::jmax(lanes * numFrames, length * numBlocks));
+
+        for (auto& sample : input)
+            sample = static_cast<SampleType>(random.nextDouble() * 2.0 - 1.0);
+
+        const auto run = [&](const KernelDispatch::FilterKernels<SampleType>& variant)
+        {
+            auto output = input;
+            std::vector<SampleType> s1((size_t)lanes, SampleType(0)), s2((size_t)lanes, SampleType(0));
+            variant.biquadFrames(output.data(), s1.data(), s2.data(), lanes, numFrames, c);
+
+            auto blocks = input;
+            SampleType b1{ 0 }, b2{ 0 };
+            variant.biquadBlocks(blocks.data(), b1, b2, numBlocks, kernel);
+
+            output.insert(output.end(), blocks.begin(), blocks.begin() + length * numBlocks);
+            return output;
+        };
+
+        const auto reference = run(KernelDispatch::getFilterKernels<SampleType>(Isa_Generic));
+        const auto output = run(kernels);
+        int numDifferent = 0;
+
+        for (size_t i = 0; i < output.size(); ++i)
+            numDifferent += isClose(output[i], reference[i]) ? 0 : 1;
+
+        expectEquals(numDifferent, 0, juce::String((int)sizeof(SampleType) * 8) + "-bit filter outputs differ from the generic variant");
+    }
+
+    void expectSpectrumKernelsAgree(const KernelDispatch::SpectrumKernels& kernels)
+    {
+        constexpr int size = 1031, fftSize = 256, halfSpan = 16;
+
+        juce::Random random(0x5e12);
+        std::vector<float> input(size), window(size);
+
+        for (int i = 0; i < size; ++i)
+        {
+            input[(size_t)i] = random.nextFloat() * 4.f;
+            window[(size_t)i] = random.nextFloat();
+        }
+
+        const auto run = [&](const KernelDispatch::SpectrumKernels& variant)
+        {
+            auto output = input;
+            variant.applyWindow(output.data(), window.data(), size);
+            variant.magnitudesToDecibels(output.data(), size, 1.f / 512.f, -48.f);
+
+            //the butterflies take their points, and stand-in twiddles, from the raw input
+            std::vector<float> real(input.begin(), input.begin() + fftSize), imag(input.begin() + fftSize, input.begin() + 2 * fftSize);
+            variant.fftButterflies(real.data(), imag.data(), window.data(), window.data() + halfSpan, fftSize, halfSpan);
+
+            output.insert(output.end(), real.begin(), real.end());
+            output.insert(output.end(), imag.begin(), imag.end());
+            return output;
+        };
+
+        const auto reference = run(KernelDispatch::getSpectrumKernels(Isa_Generic));
+        const auto output = run(kernels);
+        int numDifferent = 0;
+
+        for (size_t i = 0; i < output.size(); ++i)
+            numDifferent += isClose(output[i], reference[i]) ? 0 : 1;
+
+        expectEquals(numDifferent, 0, "spectrum outputs differ from the generic variant");
+    }
+};
+
+static KernelDispatchTests kernelDispatchTests;
@@ -0,0 +1,35 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Runs the plugin's unit tests and benchmarks. With no argument every test
+    runs; otherwise only the named category, e.g. "SimpleEQ" for the tests or
+    "Benchmarks" for the timings. Exits non-zero when any test fails.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    //the processor's parameters and the convolvers expect a message thread
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+
+    if (argc > 1)
+        runner.runTestsInCategory(argv[1]);
+    else
+        runner.runAllTests();
+
+    for (int index = 0; index < runner.getNumResults(); ++index)
+    {
+        if (runner.getResult(index)->failures > 0)
+            return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    PeakCoefficientTableTests.cpp
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/PeakCoefficientTable.h"
+
+/** Sweeps the parameter ranges and checks the table designs against the exact ones at and around the
+    centre frequency, at the common sample rates.
+*/
+class PeakCoefficientTableTests : public juce::UnitTest
+{
+public:
+    PeakCoefficientTableTests() : juce::UnitTest("Peak coefficient table", "SimpleEQ") {}
+
+    void runTest() override
+    {
+        constexpr double toleranceInDecibels = 0.01;
+        const double qualities[] = { 0.1, 0.71, 10.0 };
+
+        for (auto sampleRate : { 44100.0, 48000.0, 96000.0, 192000.0 })
+        {
+            beginTest("Accuracy at " + juce::String(sampleRate) + " Hz");
+
+            PeakCoefficientTable table;
+            table.prepare(sampleRate);
+
+            const auto maxFrequency = sampleRate * 0.49;
+            double worstError = 0.0;
+
+            for (int f = 0; f <= 40; ++f)
+            {
+                const auto freq = juce::mapToLog10(f / 40.0, 20.0, juce::jmin(20000.0, maxFrequency));
+
+                for (auto gain = PeakCoefficientTable::minGainInDecibels; gain <= PeakCoefficientTable::maxGainInDecibels; gain += 1.5)
+                {
+                    for (auto q : qualities)
+                    {
+                        BiquadCoefficients<double> approx;
+                        expect(table.makePeakFilter(sampleRate, freq, q, gain, approx));
+
+                        const auto exact = makeBiquadCoefficients(juce::dsp::IIR::ArrayCoefficients<double>::makePeakFilter(sampleRate, freq, q, juce::Decibels::decibelsToGain(gain)));
+
+                        for (auto probe : { freq * 0.5, freq, juce::jmin(freq * 2.0, maxFrequency) })
+                        {
+                            const auto error = std::abs(juce::Decibels::gainToDecibels(approx.getMagnitudeForFrequency(probe, sampleRate))
+                                                      - juce::Decibels::gainToDecibels(exact.getMagnitudeForFrequency(probe, sampleRate)));
+                            worstError = juce::jmax(worstError, error);
+                        }
+                    }
+                }
+            }
+
+            logMessage("Worst error " + juce::String(worstError, 5) + " dB");
+            expectLessThan(worstError, toleranceInDecibels);
+        }
+
+        beginTest("Designs outside the tables are refused");
+
+        PeakCoefficientTable table;
+        table.prepare(48000.0);
+
+        BiquadCoefficients<double> coefficients;
+        expect(!table.makePeakFilter(44100.0, 1000.0, 1.0, 0.0, coefficients), "a design for another rate was accepted");
+        expect(!table.makePeakFilter(48000.0, 1000.0, 1.0, 30.0, coefficients), "a gain beyond the table was accepted");
+        expect(!table.makePeakFilter(48000.0, 5.0, 1.0, 0.0, coefficients), "a frequency below the table was accepted");
+    }
+};
+
+static PeakCoefficientTableTests peakCoefficientTableTests;
@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    StateSerialiserTests.cpp
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+
+/** Round-trips sessions through the binary state, with and without the snapshots extension, and
+    checks that a block holding only some parameters, as a preset's does, moves only those.
+*/
+class StateSerialiserTests : public juce::UnitTest
+{
+public:
+    StateSerialiserTests() : juce::UnitTest("State serialiser", "SimpleEQ") {}
+
+    void runTest() override
+    {
+        beginTest("Parameters and snapshots round-trip");
+        {
+            SimpleEQAudioProcessor source;
+            setPeakFreq(source, 0.2f);
+            source.storeSnapshot(0);
+            setPeakFreq(source, 0.8f);
+            source.storeSnapshot(1);
+            setPeakFreq(source, 0.5f);
+
+            juce::MemoryBlock state;
+            source.getStateInformation(state);
+
+            juce::MemoryBlock extension;
+            expect(StateSerialiser::findExtension(state.getData(), (int)state.getSize(), SimpleEQAudioProcessor::snapshotsExtensionTag, extension));
+
+            SimpleEQAudioProcessor destination;
+            destination.setStateInformation(state.getData(), (int)state.getSize());
+
+            expectEquals(getPeakFreq(destination), getPeakFreq(source));
+            expectEquals(destination.getNumSnapshots(), 2);
+
+            //storing again from the restored processor has to give back the same block
+            juce::MemoryBlock restoredState;
+            destination.getStateInformation(restoredState);
+            expect(restoredState == state, "the restored snapshots didn't save as they were loaded");
+        }
+
+        beginTest("A session without snapshots clears them");
+        {
+            SimpleEQAudioProcessor source;
+            juce::MemoryBlock state;
+            source.getStateInformation(state);
+
+            juce::MemoryBlock extension;
+            expect(!StateSerialiser::findExtension(state.getData(), (int)state.getSize(), SimpleEQAudioProcessor::snapshotsExtensionTag, extension));
+
+            SimpleEQAudioProcessor destination;
+            destination.storeSnapshot(0);
+            destination.storeSnapshot(1);
+            destination.setStateInformation(state.getData(), (int)state.getSize());
+
+            expectEquals(destination.getNumSnapshots(), 0);
+        }
+
+        beginTest("A block of some parameters leaves the rest alone");
+        {
+            SimpleEQAudioProcessor processor;
+            StateSerialiser serialiser(processor);
+
+            std::vector<float> values;
+
+            for (int parameter = 0; parameter < serialiser.getNumParameters(); ++parameter)
+                values.push_back(serialiser.getParameter(parameter).getValue());
+
+            const auto peakFreq = findParameter(serialiser, getParameterID(Param_PeakFreq));
+            const auto linearPhase = findParameter(serialiser, getParameterID(Param_LinearPhase));
+            values[(size_t)peakFreq] = 0.3f;
+            values[(size_t)linearPhase] = 1.f;
+
+            juce::MemoryBlock block;
+            serialiser.write(block, values, { peakFreq });
+
+            expect(serialiser.read(block.getData(), (int)block.getSize()));
+            expectWithinAbsoluteError(getPeakFreq(processor), 0.3f, 1.0e-3f);
+            expectEquals(serialiser.getParameter(linearPhase).getValue(), 0.f);
+        }
+    }
+
+private:
+    static void setPeakFreq(SimpleEQAudioProcessor& processor, float normalisedValue)
+    {
+        processor.apvts.getParameter(getParameterID(Param_PeakFreq))->setValueNotifyingHost(normalisedValue);
+    }
+
+    static float getPeakFreq(SimpleEQAudioProcessor& processor)
+    {
+        return processor.apvts.getParameter(getParameterID(Param_PeakFreq))->getValue();
+    }
+
+    static int findParameter(const StateSerialiser& serialiser, juce::StringRef parameterID)
+    {
+        for (int parameter = 0; parameter < serialiser.getNumParameters(); ++parameter)
+        {
+            if (serialiser.getParameter(parameter).getParameterID() == parameterID)
+                return parameter;
+        }
+
+        return -1;
+    }
+};
+
+static StateSerialiserTests stateSerialiserTests;